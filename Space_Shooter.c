@@ -3,17 +3,378 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/* projection de l'archive des ressources en memoire ; ailleurs elle est lue d'un bloc */
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define ARCHIVE_MMAP
+#endif
+
+/* noyaux SIMD de collision : SSE2/AVX2 choisis a l'execution, sinon version scalaire */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define COLLISIONS_X86
+#define CIBLE_SSE2 __attribute__((target("sse2")))
+#define CIBLE_AVX2 __attribute__((target("avx2")))
+#endif
+
 /* resolution : 320x240 */
 /* ligne de commande pour la compilation : gcc -o Space_Shooter Space_Shooter.c -lm $(sdl2-config --cflags --libs) -l SDL2_ttf */
 /* pour utiliser valgrind (memoire) : valgrind -s --tool=memcheck --leak-check=yes|no|full|summary --leak-resolution=low|med|high --show-reachable=yes ./Space_Shooter */
 
-typedef struct Hitbox
+/* capacites des pools d'entites, modifiables a la compilation (ex : -D CAPACITE_FIREPLAYERS=4096) */
+#ifndef CAPACITE_MOBS
+#define CAPACITE_MOBS 256
+#endif
+#ifndef CAPACITE_FIREPLAYERS
+#define CAPACITE_FIREPLAYERS 1024
+#endif
+#ifndef CAPACITE_TEXTS
+#define CAPACITE_TEXTS 64
+#endif
+#ifndef CAPACITE_PROJECTILES
+#define CAPACITE_PROJECTILES 16384
+#endif
+
+/* cadence de la simulation (ticks par seconde, modifiable avec --tps) et nombre maximum
+   de ticks rattrapes par frame avant d'abandonner le retard */
+#ifndef TICKS_PAR_SECONDE
+#define TICKS_PAR_SECONDE 60
+#endif
+#define MAX_TICKS_PAR_FRAME 5
+
+/* attente hybride : SDL_Delay jusqu'a MARGE_ATTENTE_MS de l'echeance, puis attente active ;
+   une frame qui se reveille plus de TOLERANCE_RETARD_US apres l'echeance est comptee en retard */
+#define MARGE_ATTENTE_MS 2
+#define TOLERANCE_RETARD_US 200
+
+/* ecrans du jeu, indices par game_state : titre, jeu, game over, options, controles, chargement */
+#define NB_SCENES 6
+#define ETAT_CHARGEMENT 5
+
+/* polices du jeu, indices des tableaux de chargement */
+#define POLICE_TITLES 0
+#define POLICE_MENU_BUTTON 1
+#define POLICE_SECONDARY_TITLES 2
+#define NB_POLICES 3
+
+/* textes fixes des ecrans ; un label d'abscisse LABEL_CENTRE est centre horizontalement */
+#define NB_LABELS_MAX 32
+#define LABEL_CENTRE -1
+
+/* chargement asynchrone : un thread ouvre les polices, rasterise les textes et decode les images,
+   le thread principal n'envoie au GPU que UPLOADS_PAR_FRAME surfaces par frame ; la file entre les
+   deux est un anneau a un producteur et un consommateur de CAPACITE_FILE_CHARGEMENT elements */
+#ifndef UPLOADS_PAR_FRAME
+#define UPLOADS_PAR_FRAME 4
+#endif
+#define CAPACITE_FILE_CHARGEMENT 64
+#define NB_IMAGES_CHARGEES 8
+#define ELEMENT_POLICE 0
+#define ELEMENT_ATLAS_GLYPHES 1
+#define ELEMENT_TEXTE 2
+#define ELEMENT_IMAGE 3
+#define CHEMINS_SPRITES "data/background.bmp", "data/ship_player.bmp", "data/ship_mob.bmp", "data/fire_player.bmp"
+
+/* replays : entrees de chaque tick en sequences (masque, nombre de ticks) little-endian apres un
+   en-tete "SSRP" version/ticks par seconde/graine/intervalle/hash des donnees, et un checksum de
+   l'etat tous les INTERVALLE_CHECKSUM ticks pour detecter une divergence a la relecture */
+#define REPLAY_VERSION 2
+#ifndef INTERVALLE_CHECKSUM
+#define INTERVALLE_CHECKSUM 600
+#endif
+#define ENTREE_UP 0x0001
+#define ENTREE_DOWN 0x0002
+#define ENTREE_LEFT 0x0004
+#define ENTREE_RIGHT 0x0008
+#define ENTREE_A 0x0010
+#define ENTREE_B 0x0020
+#define ENTREE_L 0x0040
+#define ENTREE_R 0x0080
+#define ENTREE_START 0x0100
+#define ENTREE_SELECT 0x0200
+#define ENTREE_TOUCHE 0x0400     /* suivi d'un Sint32 : touche choisie dans le menu des controles */
+#define NB_ACTIONS 10            /* ENTREE_UP a ENTREE_SELECT : l'action i est le bit 1 << i */
+#define REPLAY_CHECKSUM 0xFFFF   /* suivi du tick (Uint64) et du checksum (Uint32) */
+#define REPLAY_FIN 0xFFFE
+
+/* traces (--trace fichier.json) : les spans termines sont ecrits dans un anneau de CAPACITE_TRACE
+   evenements, les plus anciens etant ecrases ; compile avec -D SANS_TRACE, les macros disparaissent */
+#ifndef CAPACITE_TRACE
+#define CAPACITE_TRACE 65536
+#endif
+#define PROFONDEUR_TRACE 16
+
+/* lot de sprites : quads collectes pendant la frame, tries par (couche, texture) puis envoyes
+   a SDL_RenderGeometry en un appel par texture et par couche */
+#ifndef CAPACITE_SPRITES
+#define CAPACITE_SPRITES 8192
+#endif
+#define NB_TEXTURES_LOT_SPRITES 256
+#define COUCHE_FOND 0
+#define COUCHE_FIREPLAYERS 1
+#define COUCHE_PLAYER 2
+#define COUCHE_MOBS 3
+#define COUCHE_PROJECTILES 4
+#define COUCHE_TEXTE 5
+
+/* atlas de glyphes : les caracteres ASCII imprimables de chaque police sont rasterises une fois */
+#define PREMIER_GLYPHE 32
+#define NB_GLYPHES 95
+#define LARGEUR_ATLAS_GLYPHES 512
+
+/* atlas de textures genere par --pack-atlas : une image et un index binaire little-endian
+   "SSAT", version, nombre d'entrees puis pour chaque sprite (longueur du chemin, chemin, x, y, w, h) */
+#define CHEMIN_ATLAS_IMAGE "data/atlas.bmp"
+#define CHEMIN_ATLAS_INDEX "data/atlas.idx"
+#define ATLAS_VERSION 1
+#define MARGE_ATLAS 1
+
+/* archive des ressources generee par --pack-archive : en-tete "SSPK", version, nombre d'entrees,
+   puis pour chaque fichier (longueur du chemin, chemin, position, taille) little-endian, et enfin
+   les contenus alignes sur ALIGNEMENT_ARCHIVE octets ; sans archive chaque fichier est ouvert seul */
+#define CHEMIN_ARCHIVE "data/assets.pak"
+#define ARCHIVE_VERSION 1
+#define ALIGNEMENT_ARCHIVE 16
+#define CHEMIN_ICONE "icone.bmp"
+
+/* timeline des vagues de mobs, une vague par ligne (tick x y nombre motif PV espacement [tir periode]) ;
+   les mobs d'une vague sont prepares AVANCE_VAGUE ticks avant leur apparition */
+#define CHEMIN_VAGUES "data/vagues.txt"
+#define NB_VAGUES_MAX 256
+#define AVANCE_VAGUE 30
+#define MOTIF_LIGNE 0
+#define MOTIF_COLONNE 1
+#define MOTIF_V 2
+#define MOTIF_CERCLE 3
+#define NB_MOTIFS 4
+
+/* projectiles ennemis : positions et vitesses en virgule fixe (VIRGULE_PROJECTILE bits), directions
+   parmi NB_DIRECTIONS, un cercle de RAYON_PROJECTILE pixels, retires apres DUREE_PROJECTILE ticks ;
+   chaque mob peut porter un emetteur qui tire tous les periode ticks selon un des motifs TIR_* */
+#define VIRGULE_PROJECTILE 8
+#define NB_DIRECTIONS 256
+#define RAYON_PROJECTILE 2
+#define VITESSE_PROJECTILE 384
+#define DUREE_PROJECTILE 600
+#define TIR_AUCUN 0
+#define TIR_RADIAL 1
+#define TIR_VISE 2
+#define TIR_SPIRALE 3
+#define NB_TIRS 4
+#define NB_BRANCHES_RADIAL 12
+#define NB_BRANCHES_VISE 3
+#define ECART_VISE 8
+#define NB_BRANCHES_SPIRALE 4
+#define PAS_SPIRALE 10
+
+/* geometrie statique du level (limites x y largeur hauteur, rectangle x y demi_largeur demi_hauteur,
+   polygone x y x1 y1 ... xn yn) : l'aire de jeu est un simple rectangle, les obstacles des hitboxes
+   indexees une fois dans grille_level */
+#define CHEMIN_NIVEAU "data/niveau.txt"
+#define NB_OBSTACLES_MAX 16
+#define BORD_HAUT 0x1
+#define BORD_BAS 0x2
+#define BORD_GAUCHE 0x4
+#define BORD_DROITE 0x8
+#define TOUS_LES_BORDS 0xF
+#define CHEMINS_POLICES "data/8-bitanco.ttf", "data/alagard.ttf", "data/upheavtt.ttf"
+#ifdef SANS_TRACE
+#define DEBUT_TRACE(trace, nom) ((void)0)
+#define FIN_TRACE(trace) ((void)0)
+#else
+#define DEBUT_TRACE(trace, nom) do { if ((trace)->actif) beginTrace((trace), (nom)); } while (0)
+#define FIN_TRACE(trace) do { if ((trace)->actif) endTrace(trace); } while (0)
+#endif
+
+/* nombre maximum de points d'une FormeHitbox */
+#define NB_POINTS_MAX_FORME 16
+
+/* nombre de points des formes traitees par les noyaux SIMD (les rectangles) */
+#define NB_POINTS_LOT 4
+
+/* grille uniforme de la broad phase : cellules de 32x32 sur l'ecran 320x240 */
+#define TAILLE_CELLULE 32
+#define NB_CELLULES_X 10
+#define NB_CELLULES_Y 8
+
+/* ordonnanceur de taches : un travailleur par coeur (--threads), les phases de mise a jour
+   decoupees en taches de TAILLE_TACHE entites reparties puis volees entre les threads */
+#define NB_THREADS_MAX 16
+#define CAPACITE_TACHES 256
+#define TAILLE_TACHE 64
+
+typedef struct FormeHitbox
 {
+    /* polygone convexe immuable, en coordonnees locales autour du centre de son cercle englobant */
     int nb_points;
-    SDL_Point *points;
-    int cercle_x, cercle_y, cercle_rayon;
+    SDL_Point points[NB_POINTS_MAX_FORME], normales[NB_POINTS_MAX_FORME];
+    int projection_min[NB_POINTS_MAX_FORME], projection_max[NB_POINTS_MAX_FORME];
+    int min_x, min_y, max_x, max_y;
+    int cercle_rayon;
+}FormeHitbox;
+
+typedef struct Hitbox
+{
+    const FormeHitbox *forme;
+    int x, y;
 }Hitbox;
 
+typedef struct Formes
+{
+    FormeHitbox mob, fireplayer, player;
+}Formes;
+
+typedef struct Grille
+{
+    int tete[NB_CELLULES_X * NB_CELLULES_Y];
+    int *entree_suivante, *entree_objet;
+    void **objets;
+    int *cellules, *candidats;      /* cellules : rectangle cx1, cy1, cx2, cy2 de chaque objet */
+    int nb_objets, nb_entrees, capacite_objets, capacite_entrees;
+    SDL_bool saturee;
+}Grille;
+
+typedef struct AxesHitbox
+{
+    int nb;
+    int x[NB_POINTS_MAX_FORME], y[NB_POINTS_MAX_FORME], min[NB_POINTS_MAX_FORME], max[NB_POINTS_MAX_FORME];
+    int points_x[NB_POINTS_MAX_FORME], points_y[NB_POINTS_MAX_FORME];
+}AxesHitbox;
+
+typedef struct LotHitbox
+{
+    /* candidats ranges en colonnes (SoA), en coordonnees du monde, pour les noyaux SIMD ;
+       seules les formes de NB_POINTS_LOT points passent par le SIMD, les autres par sat() */
+    int nb, capacite, nb_irreguliers;
+    int *cercle_x, *cercle_y, *cercle_rayon;
+    int *points_x[NB_POINTS_LOT], *points_y[NB_POINTS_LOT];
+    int *etiquettes, *irreguliers;
+    Hitbox **hitboxes;
+    Uint32 *masque;
+    void (*noyau)(Hitbox *hitbox, struct LotHitbox *lot, AxesHitbox *axes);
+    const char *nom_noyau;
+}LotHitbox;
+
+typedef struct Horloge
+{
+    Uint64 frequence, duree_tick, accumulateur, precedent, tolerance;
+    int ticks_par_seconde;
+    Uint64 nb_ticks, nb_frames, nb_frames_rattrapage, nb_frames_en_retard, nb_ticks_sautes;
+    Uint64 nb_transitions, duree_transitions, duree_max_transition;    /* premiere frame apres un changement d'ecran */
+    Uint64 duree_premiere_frame, duree_premier_menu;                   /* depuis le lancement du programme */
+    SDL_bool mesure_latence;                                           /* --latence : appui -> SDL_RenderPresent */
+    Uint64 nb_latences, somme_latences;
+    Uint32 latence_max;
+}Horloge;
+
+typedef struct Replay
+{
+    SDL_RWops *fichier;
+    SDL_bool enregistrement, lecture;
+    Uint32 graine, intervalle_checksum;
+    Uint32 hash_donnees;                /* timeline des vagues et niveau avec lesquels il a ete enregistre */
+    int ticks_par_seconde;
+    Uint16 masque, nb_repetitions;      /* sequence en cours d'ecriture ou de lecture */
+    Uint64 tick, nb_checksums, nb_divergences;
+}Replay;
+
+typedef struct EvenementTrace
+{
+    const char *nom;
+    Uint64 debut, duree;
+    Uint32 frame;
+    int profondeur;
+}EvenementTrace;
+
+typedef struct Trace
+{
+    SDL_bool actif;
+    const char *chemin;
+    EvenementTrace *evenements;
+    Uint64 nb_evenements;           /* nombre total de spans termines, l'anneau n'en garde que CAPACITE_TRACE */
+    const char *noms[PROFONDEUR_TRACE];
+    Uint64 debuts[PROFONDEUR_TRACE];
+    int profondeur;
+    Uint32 frame;
+    Uint64 origine, frequence;
+}Trace;
+
+typedef struct LotSprites
+{
+    SDL_Texture *textures[NB_TEXTURES_LOT_SPRITES];
+    float largeurs[NB_TEXTURES_LOT_SPRITES], hauteurs[NB_TEXTURES_LOT_SPRITES];
+    int nb_textures;
+    Uint16 *cles, *cles_triees;             /* couche << 8 | indice de texture dans la frame */
+    int *ordre, *ordre_trie;
+    SDL_Rect *src, *dst;
+    SDL_Color *couleurs;
+    SDL_Vertex *sommets;
+    int *indices;                           /* 0 1 2 2 3 0 decales de 4 par sprite, communs a tous les appels */
+    int nb, capacite;
+    int nb_draw_calls, nb_draw_calls_frame, max_sprites;
+    int nb_copies, nb_copies_frame;         /* SDL_RenderCopy hors lot : textes et lot desactive */
+    Uint64 nb_frames, total_draw_calls, total_sprites, nb_sprites_frame;
+}LotSprites;
+
+typedef struct EntreeAtlas
+{
+    char chemin[64];
+    SDL_Rect rect;
+}EntreeAtlas;
+
+typedef struct Atlas
+{
+    EntreeAtlas *entrees;
+    int nb;
+}Atlas;
+
+typedef struct EntreeArchive
+{
+    char chemin[64];
+    Uint32 position, taille;
+}EntreeArchive;
+
+typedef struct Archive
+{
+    const Uint8 *donnees;                   /* fichier entier, projete ou lu en memoire */
+    size_t taille;
+    SDL_bool projetee;
+    EntreeArchive *entrees;
+    int nb;
+}Archive;
+
+typedef struct Arene
+{
+    /* allocation par simple increment dans un bloc unique, liberee d'un coup */
+    char *memoire;
+    size_t taille, utilise;
+    SDL_bool mesure;                        /* sans memoire : allocArene ne fait que compter les octets demandes */
+    SDL_bool pleine;                        /* une allocation a deja ete refusee */
+    const char *nom;
+}Arene;
+
+typedef struct Pool
+{
+    char *memoire;
+    void *libres;
+    Uint32 *generations;                    /* par bloc, augmentee a chaque allocation neuve et a chaque liberation */
+    Arene *arene;                           /* NULL : blocs alloues par le pool lui-meme ; les generations le sont toujours */
+    size_t taille_bloc;
+    int capacite, nb_neufs, nb_utilises, nb_max_utilises, nb_refus;   /* nb_neufs : blocs deja sortis une fois */
+    Uint64 nb_allocations;
+    const char *nom;
+}Pool;
+
+typedef struct Poignee
+{
+    /* reference a un bloc de pool (Mob, FirePlayer, ...) : indice du bloc et generation du bloc
+       quand la poignee a ete prise ; aucune generation ne vaut 0, {0, 0} est la poignee nulle */
+    Uint32 indice, generation;
+}Poignee;
+
 typedef struct Text
 {
     int x, y;
@@ -22,20 +383,51 @@ typedef struct Text
     struct Text *suivant;
 }Text;
 
+typedef struct CachedTexture
+{
+    char chemin[64];
+    SDL_Texture *texture;
+    int nb_references;
+    struct CachedTexture *suivant;
+}CachedTexture;
+
+typedef struct TextureCache
+{
+    CachedTexture liste_texture;
+    int nb_hits, nb_misses;
+}TextureCache;
+
+typedef struct Glyphe
+{
+    SDL_Rect rect;                          /* dans la texture de la police */
+    int avance;
+}Glyphe;
+
+typedef struct PoliceAtlas
+{
+    SDL_Texture *texture;
+    Glyphe glyphes[NB_GLYPHES];
+    Sint8 crenage[NB_GLYPHES][NB_GLYPHES];  /* kerning entre deux glyphes consecutifs */
+    int hauteur;
+}PoliceAtlas;
+
 typedef struct Fonts
 {
     TTF_Font *titles, *menu_button, *secondary_titles;
+    PoliceAtlas atlas_titles, atlas_menu_button, atlas_secondary_titles;
     SDL_Color rouge, vert, vert_clair;
 }Fonts;
 
 typedef struct Input
 {
-    SDL_bool key[SDL_NUM_SCANCODES];
     SDL_bool quit;
-    SDL_KeyCode wanted_input;
+    SDL_Keycode wanted_input;               /* touche capturee pour le menu des controles, -1 sinon */
     SDL_Keycode key_up, key_down, key_left, key_right, key_L, key_R, key_start, key_select, key_A, key_B;  /* /;8;7;9;A;Z;Return;E;Space;D */
+    SDL_Scancode scancodes[NB_ACTIONS];     /* key_* resolues par compileActions, dans l'ordre des bits ENTREE_* */
+    Uint16 enfonce, presse, relache;        /* actions tenues, pressees et relachees pendant le tick */
+    Uint32 horodatage;                      /* timestamp SDL du premier appui pas encore affiche, 0 sinon */
     SDL_bool up, down, left, right, L, R, start, select, A, B;
-    SDL_bool select_on_cooldown, start_on_cooldown, waiting_for_input;
+    SDL_bool waiting_for_input;
 }Input;
 
 typedef struct Button
@@ -44,28 +436,67 @@ typedef struct Button
     struct Button *upward, *downward, *to_the_left, *to_the_right;
 }Button;
 
+typedef struct Emetteur
+{
+    int tir, periode, minuterie;            /* minuterie : ticks avant le prochain tir */
+    int direction;                          /* direction de depart de la prochaine salve (spirale) */
+}Emetteur;
+
 typedef struct Mob
 {
-    int x, y;
     SDL_Texture *texture;
     SDL_Rect src_rect, dst_rect;
     Hitbox hitbox;
     int PV;
+    Emetteur emetteur;
+    SDL_bool mort;                          /* retire de la liste au prochain sweepMobs */
     struct Mob *suivant;
 }Mob;
 
+typedef struct Vague
+{
+    Uint32 tick;                            /* depuis le debut du cycle de la timeline */
+    int x, y, nombre, motif, PV, espacement, tir, periode;
+    Mob *prets, *dernier_pret;              /* mobs deja alloues et places, hors de liste_mob */
+    int nb_prets;
+}Vague;
+
+typedef struct Vagues
+{
+    Vague *modele;                          /* timeline lue une fois, triee par tick */
+    Vague *vagues;                          /* copie de la partie en cours, dans l'arene de session */
+    int nb, suivante, a_preparer;           /* prochaine vague a faire apparaitre, a preparer */
+    Uint32 tick;
+    Uint64 nb_apparus;
+}Vagues;
+
+typedef struct Projectiles
+{
+    /* projectiles ennemis ranges en colonnes (SoA), sans noeud ni texture par projectile ;
+       bit i de retires / touches : projectile i a retirer / qui a touche le joueur a ce tick */
+    int nb, capacite, nb_max, nb_refus;
+    Sint32 *x, *y, *vx, *vy, *duree;
+    Uint32 *retires, *touches;
+    Sint32 direction_x[NB_DIRECTIONS], direction_y[NB_DIRECTIONS];
+    void (*noyau)(struct Projectiles *projectiles, const int bornes[4], int cible_x, int cible_y, int distance2);
+    const char *nom_noyau;
+    SDL_Texture *texture;
+    SDL_Rect src_rect;
+    Uint64 nb_tires;
+    Arene *arene;                           /* NULL : colonnes allouees par createProjectiles */
+}Projectiles;
+
 typedef struct FirePlayer
 {
-    int x, y;
     SDL_Texture *texture;
     SDL_Rect src_rect, dst_rect;
     Hitbox hitbox;
+    SDL_bool mort;                          /* retire de la liste au prochain sweepFirePlayers */
     struct FirePlayer *suivant;
 }FirePlayer;
 
 typedef struct Player
 {
-    int x, y;
     SDL_Texture *texture;
     SDL_Rect src_rect, dst_rect;
     Hitbox hitbox;
@@ -82,30 +513,271 @@ typedef struct Level
     Button start_game, quit_game, settings, back_to_menu, control_settings, control_back_to_settings;
     Button chg_up, chg_down, chg_left, chg_right, chg_L, chg_R, chg_start, chg_select, chg_A, chg_B;
     Button *selected_button;
-    SDL_Rect src_rect;
+    SDL_Rect src_rect, rect_fond;           /* src_rect defile dans l'image de fond, placee en rect_fond dans sa texture */
     int frame, delay_button;
-    int nb_hitboxes;
+    SDL_Rect limites;                       /* aire de jeu */
+    int nb_hitboxes;                        /* obstacles statiques, charges une fois avec le level */
     Hitbox *hitboxes;
+    FormeHitbox *formes;
 }Level;
 
+struct Everything;
+
+typedef struct Scene
+{
+    const char *nom;
+    void (*update)(struct Everything *all);
+    void (*draw)(struct Everything *all);
+}Scene;
+
+typedef struct Label
+{
+    Text **text;                            /* champ du Level qui recevra le texte */
+    int police;
+    const char *chaine;
+    SDL_Color *couleur;
+    int x, y;
+}Label;
+
+typedef struct ElementCharge
+{
+    int type, indice;                       /* indice de la police ou du label */
+    const char *chemin;                     /* cle de l'image dans le cache de textures */
+    TTF_Font *font;
+    SDL_Surface *surface;                   /* liberee par le thread principal apres l'envoi au GPU */
+}ElementCharge;
+
+typedef struct Chargeur
+{
+    SDL_Thread *thread;
+    ElementCharge file[CAPACITE_FILE_CHARGEMENT];
+    SDL_atomic_t nb_pousses, nb_retires;    /* seul le thread pousse, seul le thread principal retire */
+    Label labels[NB_LABELS_MAX];
+    PoliceAtlas *atlas[NB_POLICES];         /* metriques remplies par le thread, texture par le principal */
+    const char *images[NB_IMAGES_CHARGEES];
+    int nb_labels, nb_images, nb_total, nb_termines;
+}Chargeur;
+
+struct Everything;
+
+typedef struct ContexteTravailleur
+{
+    /* tampons propres a un thread : lot et candidats de ses requetes, touches de la phase des mobs */
+    LotHitbox lot;
+    int *candidats, *touches;
+    int nb_touches, capacite_touches, id;
+    Uint64 nb_sat, nb_rejets_cercle, nb_paires_lot;   /* compteurs_collision du thread, reportes apres chaque tache */
+    struct Ordonnanceur *ordonnanceur;
+}ContexteTravailleur;
+
+typedef struct Tache
+{
+    void (*fonction)(struct Everything *all, ContexteTravailleur *contexte, int debut, int fin);
+    int debut, fin;
+}Tache;
+
+typedef struct FileTaches
+{
+    /* indices de taches : le thread proprietaire retire par le bas, les voleurs par le haut */
+    int indices[CAPACITE_TACHES];
+    int haut, bas;
+    SDL_SpinLock verrou;
+}FileTaches;
+
+typedef struct Ordonnanceur
+{
+    int nb_threads, nb_taches, capacite_entites, capacite_candidats;
+    SDL_Thread *threads[NB_THREADS_MAX];    /* threads[0] inutilise : le thread principal travaille aussi */
+    FileTaches files[NB_THREADS_MAX];
+    ContexteTravailleur contextes[NB_THREADS_MAX];
+    Tache taches[CAPACITE_TACHES];
+    SDL_sem *reveil;
+    SDL_atomic_t restantes, arret, nb_vols;
+    Uint64 nb_phases, nb_phases_paralleles;
+    struct Everything *all;
+    /* tableaux des phases, indices dans l'ordre des listes chainees */
+    Mob **mobs;
+    FirePlayer **tirs;
+    Uint8 *sortis;
+    int *touches_debut, *touches_nb, *touches_contexte;
+}Ordonnanceur;
+
+typedef struct Session
+{
+    /* une partie, de Start Game au Game Over : pools de mobs et de tirs, colonnes des projectiles et
+       copie de la timeline sont taillees dans l'arene, remise a zero d'un coup a chaque Game Over ;
+       les textures des mobs et des tirs sont prises une fois par partie et pretees a chaque spawn */
+    Arene arene;
+    SDL_Texture *texture_mob, *texture_fireplayer;
+    SDL_Rect src_mob, src_fireplayer;
+    int nb_parties;
+    size_t max_octets;
+}Session;
+
+typedef struct Compteurs
+{
+    /* compteurs par frame (par tick en headless) : overlay sur key_select, --compteurs et --zero-alloc ;
+       les valeurs sont celles de la derniere frame terminee */
+    SDL_bool affiche, zero_allocation;
+    FILE *sortie;                           /* CSV d'une ligne par frame, stdout pour "-" */
+    Uint64 nb_frames, nb_frames_jeu, nb_frames_allocation;
+    int nb_malloc, nb_free, nb_copies, nb_geometries, nb_mobs, nb_fireplayers, nb_texts;
+    Uint64 nb_rejets_cercle, nb_sat_complets;
+    size_t octets_textures;
+    int malloc_precedent, free_precedent, etat_precedent;
+    Uint64 sat_precedent, rejets_precedent;
+}Compteurs;
+
 typedef struct Everything
 {
     Player player;
     FirePlayer liste_fireplayer;
-    Mob liste_mob;
+    Mob liste_mob, *dernier_mob;            /* dernier noeud de liste_mob, &liste_mob si elle est vide */
+    Vagues vagues;
+    Projectiles projectiles;
     Level level;
     Text liste_text;
+    TextureCache textures;
+    Pool pool_mobs, pool_fireplayers, pool_texts;
+    Session session;
+    Compteurs compteurs;
+    Grille grille_level, grille_fireplayers;
+    LotHitbox lot;
+    Ordonnanceur ordonnanceur;
+    Formes formes;
+    Horloge horloge;
+    Replay replay;
+    Trace trace;
+    LotSprites sprites;
+    Atlas atlas;
     Fonts fonts;
-    int game_state;
+    Chargeur chargeur;
+    int game_state, nb_mobs_morts, nb_fireplayers_morts;
+    Scene scenes[NB_SCENES], *scene;       /* scene = &scenes[game_state] */
+    SDL_bool headless;
     Input input;
     SDL_Renderer *renderer;
     SDL_Window *window;
 }Everything;
 
+/* compteurs des tests de collision : globaux car sat() et les noyaux ne recoivent pas Everything,
+   propres a chaque thread pour que les travailleurs de l'ordonnanceur puissent compter sans verrou */
+typedef struct CompteursCollision
+{
+    Uint64 nb_sat, nb_rejets_cercle, nb_paires_lot;   /* nb_sat : tests par sat() ou par une voie d'un noyau de lot,
+                                                         nb_rejets_cercle : ceux arretes par les cercles */
+}CompteursCollision;
+
+_Thread_local CompteursCollision compteurs_collision = {0, 0, 0};
+
+/* compteurs d'allocations : globaux car les fonctions memoire installees dans la SDL ne recoivent pas Everything,
+   atomiques car le thread de chargement et les travailleurs de l'ordonnanceur allouent aussi */
+typedef struct CompteursMemoire
+{
+    SDL_malloc_func malloc_origine;
+    SDL_calloc_func calloc_origine;
+    SDL_realloc_func realloc_origine;
+    SDL_free_func free_origine;
+    SDL_atomic_t nb_malloc, nb_free;
+}CompteursMemoire;
+
+CompteursMemoire compteurs_memoire;
+
+/* archive des ressources : globale car lue aussi par le thread de chargement et loadImage,
+   qui ne recoivent pas Everything ; en lecture seule apres loadArchive */
+Archive archive = {NULL, 0, SDL_FALSE, NULL, 0};
+
+void *mallocCompte(size_t taille)
+{
+    SDL_AtomicAdd(&compteurs_memoire.nb_malloc, 1);
+    return compteurs_memoire.malloc_origine(taille);
+}
+
+void *callocCompte(size_t nb, size_t taille)
+{
+    SDL_AtomicAdd(&compteurs_memoire.nb_malloc, 1);
+    return compteurs_memoire.calloc_origine(nb, taille);
+}
+
+void *reallocCompte(void *bloc, size_t taille)
+{
+    /* un realloc compte comme une allocation, et aussi comme une liberation s'il deplace un bloc existant */
+    SDL_AtomicAdd(&compteurs_memoire.nb_malloc, 1);
+    if (bloc != NULL)
+    {
+        SDL_AtomicAdd(&compteurs_memoire.nb_free, 1);
+    }
+    return compteurs_memoire.realloc_origine(bloc, taille);
+}
+
+void freeCompte(void *bloc)
+{
+    if (bloc != NULL)
+    {
+        SDL_AtomicAdd(&compteurs_memoire.nb_free, 1);
+    }
+    compteurs_memoire.free_origine(bloc);
+}
+
+void installCompteursMemoire(void)
+{
+    /* avant tout appel a la SDL : chaque SDL_malloc/SDL_free du programme, de la SDL et de SDL_ttf passe par les compteurs */
+    SDL_GetMemoryFunctions(&compteurs_memoire.malloc_origine, &compteurs_memoire.calloc_origine,
+                           &compteurs_memoire.realloc_origine, &compteurs_memoire.free_origine);
+    if (SDL_SetMemoryFunctions(mallocCompte, callocCompte, reallocCompte, freeCompte) != 0)
+    {
+        fprintf(stderr, "Erreur SDL_SetMemoryFunctions : %s\n", SDL_GetError());
+    }
+}
+
+void compileActions(Input *input)
+{
+    /* a rappeler a chaque changement de touche : les evenements ne font ensuite que comparer des scancodes */
+    SDL_Keycode touches[NB_ACTIONS] = {input->key_up, input->key_down, input->key_left, input->key_right, input->key_A,
+                                       input->key_B, input->key_L, input->key_R, input->key_start, input->key_select};
+    for (int i = 0; i < NB_ACTIONS; i++)
+    {
+        input->scancodes[i] = SDL_GetScancodeFromKey(touches[i]);
+    }
+    input->enfonce = 0;
+}
+
+Uint16 actionScancode(Input *input, SDL_Scancode scancode)
+{
+    Uint16 actions = 0;
+    for (int i = 0; i < NB_ACTIONS; i++)
+    {
+        if (input->scancodes[i] == scancode)
+        {
+            actions |= 1 << i;
+        }
+    }
+    return actions;
+}
+
+void applyMasque(Input *input, Uint16 masque)
+{
+    input->up = (masque & ENTREE_UP) ? SDL_TRUE : SDL_FALSE;
+    input->down = (masque & ENTREE_DOWN) ? SDL_TRUE : SDL_FALSE;
+    input->left = (masque & ENTREE_LEFT) ? SDL_TRUE : SDL_FALSE;
+    input->right = (masque & ENTREE_RIGHT) ? SDL_TRUE : SDL_FALSE;
+    input->A = (masque & ENTREE_A) ? SDL_TRUE : SDL_FALSE;
+    input->B = (masque & ENTREE_B) ? SDL_TRUE : SDL_FALSE;
+    input->L = (masque & ENTREE_L) ? SDL_TRUE : SDL_FALSE;
+    input->R = (masque & ENTREE_R) ? SDL_TRUE : SDL_FALSE;
+    input->start = (masque & ENTREE_START) ? SDL_TRUE : SDL_FALSE;
+    input->select = (masque & ENTREE_SELECT) ? SDL_TRUE : SDL_FALSE;
+}
+
 void updateEvent(Input *input)
 {
+    /* les evenements ne modifient que des bits d'actions ; start et select ne valent vrai
+       qu'au tick ou ils sont presses, les autres tant qu'ils sont tenus et au moins au tick
+       de l'appui, meme si la touche est deja relachee */
     SDL_Event event;
+    Uint16 actions, precedent = input->enfonce;
     input->wanted_input = -1;
+    input->presse = 0;
     while(SDL_PollEvent(&event))
     {
         if(event.type == SDL_QUIT)
@@ -116,653 +788,4636 @@ void updateEvent(Input *input)
             {
                 input->wanted_input = SDL_GetKeyFromScancode(event.key.keysym.scancode);
             }
-            input->key[event.key.keysym.scancode] = SDL_TRUE;
+            actions = actionScancode(input, event.key.keysym.scancode);
+            if (actions != 0 && !event.key.repeat)
+            {
+                input->presse |= actions;
+                input->enfonce |= actions;
+                if (input->horodatage == 0)
+                {
+                    input->horodatage = event.key.timestamp;
+                }
+            }
         }
         else if(event.type == SDL_KEYUP)
-            input->key[event.key.keysym.scancode] = SDL_FALSE;
+            input->enfonce &= ~actionScancode(input, event.key.keysym.scancode);
     }
-    input->A = input->key[SDL_GetScancodeFromKey(input->key_A)];
-    input->B = input->key[SDL_GetScancodeFromKey(input->key_B)];
-    input->down = input->key[SDL_GetScancodeFromKey(input->key_down)];
-    input->L = input->key[SDL_GetScancodeFromKey(input->key_L)];
-    input->left = input->key[SDL_GetScancodeFromKey(input->key_left)];
-    input->R = input->key[SDL_GetScancodeFromKey(input->key_R)];
-    input->right = input->key[SDL_GetScancodeFromKey(input->key_right)];
-    input->up = input->key[SDL_GetScancodeFromKey(input->key_up)];
-    if (input->select)
+    /* un appui et son relachement dans le meme tick comptent aussi comme relache */
+    input->relache = (precedent | input->presse) & ~input->enfonce;
+    applyMasque(input, (input->enfonce & ~(ENTREE_START | ENTREE_SELECT)) | input->presse);
+}
+
+void initHorloge(Horloge *horloge, int ticks_par_seconde)
+{
+    horloge->frequence = SDL_GetPerformanceFrequency();
+    horloge->ticks_par_seconde = ticks_par_seconde;
+    horloge->duree_tick = horloge->frequence / ticks_par_seconde;
+    horloge->tolerance = horloge->frequence * TOLERANCE_RETARD_US / 1000000;
+    horloge->precedent = SDL_GetPerformanceCounter();
+    horloge->accumulateur = horloge->duree_tick;    /* le premier tick part tout de suite */
+    horloge->nb_ticks = 0;
+    horloge->nb_frames = 0;
+    horloge->nb_frames_rattrapage = 0;
+    horloge->nb_frames_en_retard = 0;
+    horloge->nb_ticks_sautes = 0;
+    horloge->nb_transitions = 0;
+    horloge->duree_transitions = 0;
+    horloge->duree_max_transition = 0;
+    horloge->duree_premiere_frame = 0;
+    horloge->duree_premier_menu = 0;
+    horloge->nb_latences = 0;
+    horloge->somme_latences = 0;
+    horloge->latence_max = 0;
+}
+
+int ticksHorloge(Horloge *horloge)
+{
+    /* ajoute le temps ecoule a l'accumulateur et renvoie le nombre de ticks a simuler,
+       plafonne a MAX_TICKS_PAR_FRAME : au-dela le retard est abandonne */
+    Uint64 maintenant = SDL_GetPerformanceCounter();
+    Uint64 nb_ticks;
+    horloge->accumulateur += maintenant - horloge->precedent;
+    horloge->precedent = maintenant;
+    nb_ticks = horloge->accumulateur / horloge->duree_tick;
+    if (nb_ticks > MAX_TICKS_PAR_FRAME)
+    {
+        horloge->nb_ticks_sautes += nb_ticks - MAX_TICKS_PAR_FRAME;
+        horloge->accumulateur -= (nb_ticks - MAX_TICKS_PAR_FRAME) * horloge->duree_tick;
+        nb_ticks = MAX_TICKS_PAR_FRAME;
+    }
+    if (nb_ticks > 1)
+    {
+        horloge->nb_frames_rattrapage += 1;
+    }
+    horloge->accumulateur -= nb_ticks * horloge->duree_tick;
+    horloge->nb_ticks += nb_ticks;
+    horloge->nb_frames += 1;
+    return (int)nb_ticks;
+}
+
+void waitHorloge(Horloge *horloge)
+{
+    /* dort jusqu'a MARGE_ATTENTE_MS du prochain tick puis finit en attente active */
+    Uint64 echeance = horloge->precedent + (horloge->duree_tick - horloge->accumulateur);
+    Uint64 marge = horloge->frequence * MARGE_ATTENTE_MS / 1000;
+    Uint64 maintenant = SDL_GetPerformanceCounter();
+    if (maintenant < echeance && echeance - maintenant > marge)
     {
-        if (input->key[SDL_GetScancodeFromKey(input->key_select)])
-        {
-            input->select_on_cooldown = SDL_TRUE;
-        }
-        input->select = SDL_FALSE;
+        SDL_Delay((Uint32)((echeance - maintenant - marge) * 1000 / horloge->frequence));
     }
-    else if (input->select_on_cooldown)
+    while ((maintenant = SDL_GetPerformanceCounter()) < echeance)
     {
-        if (!input->key[SDL_GetScancodeFromKey(input->key_select)])
-        {
-            input->select_on_cooldown = SDL_FALSE;
-        }
     }
-    else
+    if (maintenant - echeance > horloge->tolerance)
     {
-        input->select = input->key[SDL_GetScancodeFromKey(input->key_select)];
+        horloge->nb_frames_en_retard += 1;
     }
+}
 
-    if (input->start)
+void reportHorloge(Horloge *horloge)
+{
+    if (horloge->frequence == 0)
     {
-        if (input->key[SDL_GetScancodeFromKey(input->key_start)])
-        {
-            input->start_on_cooldown = SDL_TRUE;
-        }
-        input->start = SDL_FALSE;
+        return;
     }
-    else if (input->start_on_cooldown)
+    printf("Horloge (%d ticks/s) : %" SDL_PRIu64 " ticks en %" SDL_PRIu64 " frames, %" SDL_PRIu64 " frames de rattrapage, %"
+           SDL_PRIu64 " frames en retard de plus de %d us, %" SDL_PRIu64 " ticks sautes\n",
+           horloge->ticks_par_seconde, horloge->nb_ticks, horloge->nb_frames, horloge->nb_frames_rattrapage,
+           horloge->nb_frames_en_retard, TOLERANCE_RETARD_US, horloge->nb_ticks_sautes);
+    if (horloge->nb_transitions > 0)
     {
-        if (!input->key[SDL_GetScancodeFromKey(input->key_start)])
-        {
-            input->start_on_cooldown = SDL_FALSE;
-        }
+        printf("Transitions d'ecran : %" SDL_PRIu64 ", premiere frame en %.0f us en moyenne, %.0f us au maximum\n",
+               horloge->nb_transitions, 1e6 * horloge->duree_transitions / horloge->nb_transitions / horloge->frequence,
+               1e6 * horloge->duree_max_transition / horloge->frequence);
     }
-    else
+    if (horloge->duree_premier_menu > 0)
+    {
+        printf("Demarrage : premiere frame en %.1f ms, premier menu en %.1f ms (%s)\n",
+               1e3 * horloge->duree_premiere_frame / horloge->frequence,
+               1e3 * horloge->duree_premier_menu / horloge->frequence,
+               (archive.nb > 0) ? CHEMIN_ARCHIVE : "fichiers separes");
+    }
+    if (horloge->nb_latences > 0)
     {
-        input->start = input->key[SDL_GetScancodeFromKey(input->key_start)];
+        printf("Latence appui -> affichage : %" SDL_PRIu64 " appuis, %.1f ms en moyenne, %u ms au maximum\n",
+               horloge->nb_latences, (double)horloge->somme_latences / horloge->nb_latences, horloge->latence_max);
     }
 }
 
-SDL_Texture *loadImage(const char chemin[], SDL_Renderer *renderer)
+void measureLatence(Horloge *horloge, Uint32 horodatage)
 {
-    SDL_Surface *surface = NULL; 
-    SDL_Texture *texture = NULL, *tmp = NULL;
-    surface = SDL_LoadBMP(chemin);
-    if(NULL == surface)
+    /* a appeler juste apres SDL_RenderPresent : premiere frame a refleter l'appui horodate,
+       a la milliseconde pres comme les timestamps des evenements SDL */
+    Uint32 latence = SDL_GetTicks() - horodatage;
+    horloge->nb_latences++;
+    horloge->somme_latences += latence;
+    if (latence > horloge->latence_max)
     {
-        fprintf(stderr, "Erreur SDL_LoadBMP : %s\n", SDL_GetError());
-        return NULL;
+        horloge->latence_max = latence;
     }
-    tmp = SDL_CreateTextureFromSurface(renderer, surface);
-    if(NULL == tmp)
+}
+
+void measureDemarrage(Horloge *horloge, Uint64 lancement, SDL_bool menu)
+{
+    /* temps entre le lancement et la premiere frame presentee, puis la premiere hors chargement */
+    Uint64 duree = SDL_GetPerformanceCounter() - lancement;
+    if (horloge->duree_premiere_frame == 0)
     {
-        fprintf(stderr, "Erreur SDL_CreateTextureFromSurface : %s\n", SDL_GetError());
-        return NULL;
+        horloge->duree_premiere_frame = duree;
     }
-    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, 
-                            SDL_TEXTUREACCESS_TARGET, surface->w, surface->h);
-    if(NULL == texture)
+    if (menu && horloge->duree_premier_menu == 0)
     {
-        fprintf(stderr, "Erreur SDL_CreateTexture : %s\n", SDL_GetError());
-        return NULL;
+        horloge->duree_premier_menu = duree;
     }
-    SDL_SetRenderTarget(renderer, texture);
-    SDL_RenderCopy(renderer, tmp, NULL, NULL);
-    SDL_DestroyTexture(tmp);
-    SDL_FreeSurface(surface);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-    return texture;
 }
 
-Text *loadText(TTF_Font *font, const char text[], SDL_Color color, Everything *all)
+void measureTransition(Horloge *horloge, Uint64 debut)
 {
-    SDL_Surface *surface = NULL; 
-    SDL_Texture *texture = NULL, *tmp = NULL;
-    Text *last = &all->liste_text;
-    while (last->suivant != NULL)
+    /* duree de la frame (ticks, affichage et present, sans l'attente) qui suit un changement d'ecran */
+    Uint64 duree = SDL_GetPerformanceCounter() - debut;
+    horloge->nb_transitions++;
+    horloge->duree_transitions += duree;
+    if (duree > horloge->duree_max_transition)
     {
-        last = last->suivant;
+        horloge->duree_max_transition = duree;
     }
-    surface = TTF_RenderText_Solid(font, text, color);
-    if(NULL == surface)
+}
+
+Uint16 masqueInput(Input *input)
+{
+    Uint16 masque = 0;
+    masque |= input->up ? ENTREE_UP : 0;
+    masque |= input->down ? ENTREE_DOWN : 0;
+    masque |= input->left ? ENTREE_LEFT : 0;
+    masque |= input->right ? ENTREE_RIGHT : 0;
+    masque |= input->A ? ENTREE_A : 0;
+    masque |= input->B ? ENTREE_B : 0;
+    masque |= input->L ? ENTREE_L : 0;
+    masque |= input->R ? ENTREE_R : 0;
+    masque |= input->start ? ENTREE_START : 0;
+    masque |= input->select ? ENTREE_SELECT : 0;
+    return masque;
+}
+
+SDL_bool openReplay(Replay *replay, const char chemin[], SDL_bool enregistrement, int ticks_par_seconde, Uint32 graine, Uint32 hash_donnees)
+{
+    char magique[4];
+    replay->fichier = SDL_RWFromFile(chemin, enregistrement ? "wb" : "rb");
+    if (replay->fichier == NULL)
     {
-        fprintf(stderr, "Erreur TTF_RenderText_Solid : %s\n", TTF_GetError());
-        return NULL;
+        fprintf(stderr, "Erreur SDL_RWFromFile : %s\n", SDL_GetError());
+        return SDL_FALSE;
     }
-    tmp = SDL_CreateTextureFromSurface(all->renderer, surface);
-    if(NULL == tmp)
-    {
-        fprintf(stderr, "Erreur SDL_CreateTextureFromSurface : %s\n", SDL_GetError());
-        return NULL;
+    replay->enregistrement = enregistrement;
+    replay->lecture = !enregistrement;
+    replay->masque = 0;
+    replay->nb_repetitions = 0;
+    replay->tick = 0;
+    replay->nb_checksums = 0;
+    replay->nb_divergences = 0;
+    if (enregistrement)
+    {
+        replay->graine = graine;
+        replay->ticks_par_seconde = ticks_par_seconde;
+        replay->intervalle_checksum = INTERVALLE_CHECKSUM;
+        replay->hash_donnees = hash_donnees;
+        SDL_RWwrite(replay->fichier, "SSRP", 1, 4);
+        SDL_WriteLE16(replay->fichier, REPLAY_VERSION);
+        SDL_WriteLE16(replay->fichier, (Uint16)ticks_par_seconde);
+        SDL_WriteLE32(replay->fichier, replay->graine);
+        SDL_WriteLE32(replay->fichier, replay->intervalle_checksum);
+        SDL_WriteLE32(replay->fichier, replay->hash_donnees);
+        return SDL_TRUE;
+    }
+    if (SDL_RWread(replay->fichier, magique, 1, 4) != 4 || SDL_memcmp(magique, "SSRP", 4) != 0
+        || SDL_ReadLE16(replay->fichier) != REPLAY_VERSION)
+    {
+        fprintf(stderr, "Erreur replay : %s n'est pas un replay de version %d\n", chemin, REPLAY_VERSION);
+        SDL_RWclose(replay->fichier);
+        replay->fichier = NULL;
+        replay->lecture = SDL_FALSE;
+        return SDL_FALSE;
     }
-    texture = SDL_CreateTexture(all->renderer, SDL_PIXELFORMAT_RGBA8888, 
-                            SDL_TEXTUREACCESS_TARGET, surface->w, surface->h);
-    if(NULL == texture)
-    {
-        fprintf(stderr, "Erreur SDL_CreateTexture : %s\n", SDL_GetError());
-        return NULL;
+    replay->ticks_par_seconde = SDL_ReadLE16(replay->fichier);
+    replay->graine = SDL_ReadLE32(replay->fichier);
+    replay->intervalle_checksum = SDL_ReadLE32(replay->fichier);
+    replay->hash_donnees = SDL_ReadLE32(replay->fichier);
+    if (replay->hash_donnees != hash_donnees)
+    {
+        /* d'autres vagues ou un autre niveau : la relecture divergerait des le premier checksum */
+        fprintf(stderr, "Erreur replay : %s a ete enregistre avec d'autres donnees (hash %08X, actuel %08X)\n",
+                chemin, replay->hash_donnees, hash_donnees);
+        SDL_RWclose(replay->fichier);
+        replay->fichier = NULL;
+        replay->lecture = SDL_FALSE;
+        return SDL_FALSE;
     }
-
-    last->suivant = SDL_malloc(sizeof(Text));
-    last->suivant->texture = texture;
-    last->suivant->src_rect.h = surface->h;
-    last->suivant->src_rect.w = surface->w;
-    last->suivant->src_rect.x = 0;
-    last->suivant->src_rect.y = 0;
-    last->suivant->dst_rect.h = surface->h;
-    last->suivant->dst_rect.w = surface->w;
-    last->suivant->dst_rect.x = 0;
-    last->suivant->dst_rect.y = 0;
-    last->suivant->x = 0;
-    last->suivant->y = 0;
-    last->suivant->suivant = NULL;
-
-    SDL_SetRenderTarget(all->renderer, texture);
-    SDL_RenderCopy(all->renderer, tmp, NULL, NULL);
-    SDL_DestroyTexture(tmp);
-    SDL_FreeSurface(surface);
-    SDL_SetRenderTarget(all->renderer, NULL);
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-    return last->suivant;
+    return SDL_TRUE;
 }
 
-SDL_bool sat(Hitbox *hitbox1, Hitbox *hitbox2)
+void flushReplay(Replay *replay)
 {
-    double min1 = 0, max1 = 0, min2 = 0, max2 = 0, p = 0;
-    int nb_axes1, nb_axes2;
-    SDL_Point normal = {.x = 0, .y = 0};
-
-    if ( (hitbox1->cercle_x-hitbox2->cercle_x)*(hitbox1->cercle_x-hitbox2->cercle_x) + (hitbox1->cercle_y-hitbox2->cercle_y)*(hitbox1->cercle_y-hitbox2->cercle_y) >
-                     (hitbox1->cercle_rayon + hitbox2->cercle_rayon)*(hitbox1->cercle_rayon + hitbox2->cercle_rayon))
+    /* ecrit la sequence en cours : un masque repete nb_repetitions ticks */
+    if (replay->nb_repetitions > 0)
     {
-        return SDL_FALSE;
+        SDL_WriteLE16(replay->fichier, replay->masque);
+        SDL_WriteLE16(replay->fichier, replay->nb_repetitions);
+        replay->nb_repetitions = 0;
     }
+}
 
-    for (int i = 0; i < hitbox1->nb_points; i++ )
+void recordReplay(Replay *replay, Input *input)
+{
+    Uint16 masque = masqueInput(input);
+    if (input->wanted_input != -1)
+    {
+        /* touche capturee dans le menu des controles : toujours un tick isole */
+        flushReplay(replay);
+        SDL_WriteLE16(replay->fichier, masque | ENTREE_TOUCHE);
+        SDL_WriteLE16(replay->fichier, 1);
+        SDL_WriteLE32(replay->fichier, (Uint32)input->wanted_input);
+        return;
+    }
+    if (replay->nb_repetitions > 0 && (masque != replay->masque || replay->nb_repetitions == 0xFFFF))
     {
-        if (i+1 >= hitbox1->nb_points)
-        {
-            normal.x = -(hitbox1->points[i].y - hitbox1->points[0].y);
-            normal.y = hitbox1->points[i].x - hitbox1->points[0].x;
-        }
-        else
-        {
-            normal.x = -(hitbox1->points[i].y - hitbox1->points[i+1].y);
-            normal.y = hitbox1->points[i].x - hitbox1->points[i+1].x;
-        }
-        min1 = normal.x * hitbox1->points[0].x + normal.y * hitbox1->points[0].y;
-        max1 = min1;
-        for (int j = 1; j < hitbox1->nb_points; j++ )
-        {
-            p = normal.x * hitbox1->points[j].x + normal.y * hitbox1->points[j].y;
-            if (p < min1)
-            {
-                min1 = p;
-            }
-            else if (p > max1)
-            {
-                max1 = p;
-            }
-        }
-        min2 = normal.x * hitbox2->points[0].x + normal.y * hitbox2->points[0].y;
-        max2 = min2;
-        for (int j = 1; j < hitbox2->nb_points; j++ )
-        {
-            p = normal.x * hitbox2->points[j].x + normal.y * hitbox2->points[j].y;
-            if (p < min2)
-            {
-                min2 = p;
-            }
-            else if (p > max2)
-            {
-                max2 = p;
-            }
-        }
-        if (min1 >= max2 || min2 >= max1)
-        {
-            return SDL_FALSE;
-        }
+        flushReplay(replay);
     }
-    
+    replay->masque = masque;
+    replay->nb_repetitions++;
+}
 
-    for (int i = 0; i < hitbox2->nb_points; i++ )
+SDL_bool readReplay(Replay *replay, Input *input)
+{
+    /* remplace les entrees du tick par celles du replay, lu au fil de l'eau ; SDL_FALSE a la fin */
+    Uint16 masque;
+    input->wanted_input = -1;
+    if (replay->nb_repetitions == 0)
     {
-        if (i+1 >= hitbox2->nb_points)
-        {
-            normal.x = -(hitbox2->points[i].y - hitbox2->points[0].y);
-            normal.y = hitbox2->points[i].x - hitbox2->points[0].x;
-        }
-        else
-        {
-            normal.x = -(hitbox2->points[i].y - hitbox2->points[i+1].y);
-            normal.y = hitbox2->points[i].x - hitbox2->points[i+1].x;
-        }
-        min1 = normal.x * hitbox1->points[0].x + normal.y * hitbox1->points[0].y;
-        max1 = min1;
-        for (int j = 1; j < hitbox1->nb_points; j++ )
+        if (SDL_RWread(replay->fichier, &masque, sizeof(masque), 1) != 1)
         {
-            p = normal.x * hitbox1->points[j].x + normal.y * hitbox1->points[j].y;
-            if (p < min1)
-            {
-                min1 = p;
-            }
-            else if (p > max1)
-            {
-                max1 = p;
-            }
+            return SDL_FALSE;
         }
-        min2 = normal.x * hitbox2->points[0].x + normal.y * hitbox2->points[0].y;
-        max2 = min2;
-        for (int j = 1; j < hitbox2->nb_points; j++ )
+        masque = SDL_SwapLE16(masque);
+        if (masque == REPLAY_FIN || masque == REPLAY_CHECKSUM)
         {
-            p = normal.x * hitbox2->points[j].x + normal.y * hitbox2->points[j].y;
-            if (p < min2)
-            {
-                min2 = p;
-            }
-            else if (p > max2)
-            {
-                max2 = p;
-            }
+            /* un checksum n'est attendu qu'aux ticks multiples de l'intervalle */
+            return SDL_FALSE;
         }
-        if (min1 >= max2 || min2 >= max1)
+        replay->masque = masque;
+        replay->nb_repetitions = SDL_ReadLE16(replay->fichier);
+        if (masque & ENTREE_TOUCHE)
         {
-            return SDL_FALSE;
+            input->wanted_input = (SDL_Keycode)SDL_ReadLE32(replay->fichier);
         }
     }
-
+    replay->nb_repetitions--;
+    applyMasque(input, replay->masque);
     return SDL_TRUE;
 }
 
-void destroyText(Text *text, Everything *all)
+Uint32 hashChecksum(Uint32 hash, Sint32 valeur)
 {
-    Text *text_liste = &all->liste_text, *tmp = NULL;
-    if (text == NULL)
-    {
-        fprintf(stderr, "Erreur dans destroyText : le Text passé en paramètre est un pointeur NULL");
-        return;
-    }
-    while (text_liste->suivant != text)
-    {
-        text_liste = text_liste->suivant;
-    }
-    if (text_liste->suivant->texture != NULL)
+    /* FNV-1a sur les 4 octets de la valeur */
+    for (int i = 0; i < 4; i++)
     {
-        SDL_DestroyTexture(text_liste->suivant->texture);
+        hash ^= (Uint32)(valeur >> (8 * i)) & 0xFF;
+        hash *= 16777619u;
     }
-    tmp = text_liste->suivant->suivant;
-    SDL_free(text_liste->suivant);
-    text_liste->suivant = tmp;
+    return hash;
 }
 
-void destroyFonts(Everything *all)
+Uint32 checksumEverything(Everything *all)
 {
-    Fonts *fonts = &all->fonts;
-    if (fonts->titles != NULL)
+    /* etat de la simulation uniquement : ce qui est dessine ou charge a l'affichage n'y entre pas */
+    Uint32 hash = 2166136261u;
+    hash = hashChecksum(hash, all->game_state);
+    hash = hashChecksum(hash, all->level.x);
+    hash = hashChecksum(hash, all->level.y);
+    hash = hashChecksum(hash, all->player.hitbox.x);
+    hash = hashChecksum(hash, all->player.hitbox.y);
+    hash = hashChecksum(hash, all->player.PV);
+    hash = hashChecksum(hash, all->player.delay_fire);
+    hash = hashChecksum(hash, all->player.invincibility_frames);
+    for (Mob *mob = all->liste_mob.suivant; mob != NULL; mob = mob->suivant)
     {
-        TTF_CloseFont(fonts->titles);
+        hash = hashChecksum(hash, mob->hitbox.x);
+        hash = hashChecksum(hash, mob->hitbox.y);
+        hash = hashChecksum(hash, mob->PV);
     }
-    if (fonts->menu_button != NULL)
+    for (FirePlayer *fire = all->liste_fireplayer.suivant; fire != NULL; fire = fire->suivant)
     {
-        TTF_CloseFont(fonts->menu_button);
+        hash = hashChecksum(hash, fire->hitbox.x);
+        hash = hashChecksum(hash, fire->hitbox.y);
     }
-    if (fonts->secondary_titles != NULL)
+    for (int i = 0; i < all->projectiles.nb; i++)
     {
-        TTF_CloseFont(fonts->secondary_titles);
+        hash = hashChecksum(hash, all->projectiles.x[i]);
+        hash = hashChecksum(hash, all->projectiles.y[i]);
     }
+    return hash;
 }
 
-void loadFonts(Everything *all)
+void checkpointReplay(Everything *all)
 {
-    Fonts *fonts = &all->fonts;
-    fonts->titles = TTF_OpenFont("data/8-bitanco.ttf", 30);
-    if (fonts->titles == NULL)
+    /* a appeler apres chaque tick : ecrit ou verifie le checksum tous les intervalle_checksum ticks */
+    Replay *replay = &all->replay;
+    Uint32 checksum, attendu;
+    Uint64 tick;
+    Uint16 masque;
+    if (!replay->enregistrement && !replay->lecture)
     {
-        fprintf(stderr, "Erreur TTF_OpenFont : %s\n", TTF_GetError());
+        return;
     }
-    fonts->menu_button = TTF_OpenFont("data/alagard.ttf", 18);
-    if (fonts->menu_button == NULL)
+    replay->tick++;
+    if (replay->intervalle_checksum == 0 || replay->tick % replay->intervalle_checksum != 0)
     {
-        fprintf(stderr, "Erreur TTF_OpenFont : %s\n", TTF_GetError());
+        return;
     }
-    fonts->secondary_titles = TTF_OpenFont("data/upheavtt.ttf", 30);
-    if (fonts->secondary_titles == NULL)
+    checksum = checksumEverything(all);
+    replay->nb_checksums++;
+    if (replay->enregistrement)
     {
-        fprintf(stderr, "Erreur TTF_OpenFont : %s\n", TTF_GetError());
+        flushReplay(replay);
+        SDL_WriteLE16(replay->fichier, REPLAY_CHECKSUM);
+        SDL_WriteLE64(replay->fichier, replay->tick);
+        SDL_WriteLE32(replay->fichier, checksum);
+        return;
     }
-    SDL_Color rouge = {200, 0, 0};
-    SDL_Color vert = {0, 200, 0};
-    SDL_Color vert_clair = {140, 200, 140};
-    fonts->rouge = rouge;
-    fonts->vert = vert;
-    fonts->vert_clair = vert_clair;
-}
-
-void destroyPlayer(Everything *all)
-{
-    if (all->player.texture != NULL)
+    if (replay->nb_repetitions != 0 || SDL_RWread(replay->fichier, &masque, sizeof(masque), 1) != 1
+        || SDL_SwapLE16(masque) != REPLAY_CHECKSUM)
     {
-        SDL_DestroyTexture(all->player.texture);
-        all->player.texture = NULL;
+        fprintf(stderr, "Erreur replay : checksum absent au tick %" SDL_PRIu64 "\n", replay->tick);
+        replay->nb_divergences++;
+        all->input.quit = SDL_TRUE;
+        return;
     }
-    if (all->player.hitbox.points != NULL)
+    tick = SDL_ReadLE64(replay->fichier);
+    attendu = SDL_ReadLE32(replay->fichier);
+    if (tick != replay->tick || attendu != checksum)
     {
-        SDL_free(all->player.hitbox.points);
-        all->player.hitbox.points = NULL;
+        if (replay->nb_divergences == 0)
+        {
+            fprintf(stderr, "Replay : divergence au tick %" SDL_PRIu64 " (checksum %08x, attendu %08x)\n",
+                    replay->tick, (unsigned)checksum, (unsigned)attendu);
+        }
+        replay->nb_divergences++;
     }
 }
 
-void destroyFirePlayer(FirePlayer *fire, Everything *all)
+void closeReplay(Replay *replay)
 {
-    FirePlayer *fire_liste = &all->liste_fireplayer, *tmp = NULL;
-    if (fire == NULL)
+    if (replay->fichier == NULL)
     {
-        fprintf(stderr, "Erreur dans destroyFirePlayer : le FirePlayer passé en paramètre est un pointeur NULL");
         return;
     }
-    while (fire_liste->suivant != fire)
-    {
-        fire_liste = fire_liste->suivant;
-    }
-    if (fire_liste->suivant->hitbox.points != NULL)
+    if (replay->enregistrement)
     {
-        SDL_free(fire_liste->suivant->hitbox.points);
+        flushReplay(replay);
+        SDL_WriteLE16(replay->fichier, REPLAY_FIN);
+        printf("Replay enregistre : %" SDL_PRIu64 " ticks, %" SDL_PRIu64 " checksums, %ld octets\n",
+               replay->tick, replay->nb_checksums, (long)SDL_RWtell(replay->fichier));
     }
-    if (fire_liste->suivant->texture != NULL)
+    else
     {
-        SDL_DestroyTexture(fire_liste->suivant->texture);
+        printf("Replay relu : %" SDL_PRIu64 " ticks, %" SDL_PRIu64 " checksums, %" SDL_PRIu64 " divergences\n",
+               replay->tick, replay->nb_checksums, replay->nb_divergences);
     }
-    tmp = fire_liste->suivant->suivant;
-    SDL_free(fire_liste->suivant);
-    fire_liste->suivant = tmp;
+    SDL_RWclose(replay->fichier);
+    replay->fichier = NULL;
 }
 
-void destroyMob(Mob *mob, Everything *all)
+SDL_bool createTrace(Trace *trace, const char chemin[])
 {
-    Mob *mob_liste = &all->liste_mob, *tmp = NULL;
-    if (mob == NULL)
+    trace->evenements = SDL_malloc(CAPACITE_TRACE * sizeof(EvenementTrace));
+    if (trace->evenements == NULL)
     {
-        fprintf(stderr, "Erreur dans destroyMob : le Mob passé en paramètre est un pointeur NULL");
-        return;
+        fprintf(stderr, "Erreur SDL_malloc : impossible d'allouer l'anneau de trace\n");
+        return SDL_FALSE;
     }
-    while (mob_liste->suivant != mob)
+    trace->chemin = chemin;
+    trace->nb_evenements = 0;
+    trace->profondeur = 0;
+    trace->frame = 0;
+    trace->frequence = SDL_GetPerformanceFrequency();
+    trace->origine = SDL_GetPerformanceCounter();
+    trace->actif = SDL_TRUE;
+    return SDL_TRUE;
+}
+
+void beginTrace(Trace *trace, const char nom[])
+{
+    /* nom doit rester valide jusqu'a l'export : en pratique une chaine litterale */
+    if (trace->profondeur < PROFONDEUR_TRACE)
     {
-        mob_liste = mob_liste->suivant;
+        trace->noms[trace->profondeur] = nom;
+        trace->debuts[trace->profondeur] = SDL_GetPerformanceCounter();
     }
-    if (mob_liste->suivant->hitbox.points != NULL)
+    trace->profondeur++;
+}
+
+void endTrace(Trace *trace)
+{
+    Uint64 fin = SDL_GetPerformanceCounter();
+    EvenementTrace *evenement;
+    if (trace->profondeur <= 0)
     {
-        SDL_free(mob_liste->suivant->hitbox.points);
+        return;
     }
-    if (mob_liste->suivant->texture != NULL)
+    trace->profondeur--;
+    if (trace->profondeur >= PROFONDEUR_TRACE)
     {
-        SDL_DestroyTexture(mob_liste->suivant->texture);
+        return;
     }
-    tmp = mob_liste->suivant->suivant;
-    SDL_free(mob_liste->suivant);
-    mob_liste->suivant = tmp;
+    evenement = &trace->evenements[trace->nb_evenements % CAPACITE_TRACE];
+    evenement->nom = trace->noms[trace->profondeur];
+    evenement->debut = trace->debuts[trace->profondeur];
+    evenement->duree = fin - evenement->debut;
+    evenement->frame = trace->frame;
+    evenement->profondeur = trace->profondeur;
+    trace->nb_evenements++;
 }
 
-void destroyLevel(Everything *all)
+void destroyTrace(Trace *trace)
 {
-    if (all->level.texture != NULL)
+    /* export au format Trace Event de Chrome (chrome://tracing, ui.perfetto.dev) puis liberation */
+    FILE *fichier;
+    Uint64 premier, i;
+    EvenementTrace *evenement;
+    if (trace->evenements == NULL)
+    {
+        return;
+    }
+    fichier = fopen(trace->chemin, "w");
+    if (fichier == NULL)
     {
-        SDL_DestroyTexture(all->level.texture);
+        fprintf(stderr, "Erreur fopen : impossible d'ecrire la trace %s\n", trace->chemin);
     }
-    if (all->level.hitboxes != NULL)
+    else
     {
-        for (int i = 0; i < all->level.nb_hitboxes; i++)
+        premier = (trace->nb_evenements > CAPACITE_TRACE) ? trace->nb_evenements - CAPACITE_TRACE : 0;
+        fprintf(fichier, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (i = premier; i < trace->nb_evenements; i++)
         {
-            if (all->level.hitboxes[i].points != NULL)
-            {
-                SDL_free(all->level.hitboxes[i].points);
-            }
+            evenement = &trace->evenements[i % CAPACITE_TRACE];
+            fprintf(fichier, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                    (i == premier) ? "" : ",\n", evenement->nom,
+                    (double)(evenement->debut - trace->origine) * 1000000.0 / trace->frequence,
+                    (double)evenement->duree * 1000000.0 / trace->frequence, (unsigned)evenement->frame);
         }
-        SDL_free(all->level.hitboxes);
-        all->level.nb_hitboxes = 0;
-    }
+        fprintf(fichier, "\n]}\n");
+        fclose(fichier);
+        printf("Trace : %" SDL_PRIu64 " spans ecrits dans %s (%" SDL_PRIu64 " ecrases)\n",
+               trace->nb_evenements - premier, trace->chemin, premier);
+    }
+    SDL_free(trace->evenements);
+    trace->evenements = NULL;
+    trace->actif = SDL_FALSE;
 }
 
-void Quit(Everything *all, int statut)
+void mesureArene(Arene *arene, const char nom[])
 {
-    /* liberation de la RAM allouee */
+    /* arene a blanc : on y rejoue un decoupage pour connaitre la taille de la vraie arene */
+    arene->nom = nom;
+    arene->utilise = 0;
+    arene->taille = 0;
+    arene->memoire = NULL;
+    arene->mesure = SDL_TRUE;
+    arene->pleine = SDL_FALSE;
+}
 
-    while (all->liste_text.suivant != NULL)
-    {
-        destroyText(all->liste_text.suivant, all);
+void createArene(Arene *arene, const char nom[], size_t taille)
+{
+    arene->nom = nom;
+    arene->utilise = 0;
+    arene->taille = 0;
+    arene->mesure = SDL_FALSE;
+    arene->pleine = SDL_FALSE;
+    arene->memoire = SDL_malloc(taille);
+    if (arene->memoire == NULL)
+    {
+        fprintf(stderr, "Erreur dans createArene : impossible d'allouer l'arene %s (%zu octets)\n", nom, taille);
+        return;
     }
-    destroyFonts(all);
-    destroyLevel(all);
-    destroyPlayer(all);
-    while (all->liste_fireplayer.suivant != NULL)
+    arene->taille = taille;
+}
+
+void *allocArene(Arene *arene, size_t taille)
+{
+    /* O(1) : blocs alignes sur 16 octets, jamais rendus un par un */
+    size_t debut = (arene->utilise + 15) & ~(size_t)15;
+    if (arene->mesure)
     {
-        destroyFirePlayer(all->liste_fireplayer.suivant, all);
+        arene->utilise = debut + taille;
+        return NULL;
     }
-    while (all->liste_mob.suivant != NULL)
+    if (debut + taille > arene->taille)
     {
-        destroyMob(all->liste_mob.suivant, all);
+        fprintf(stderr, "Erreur dans allocArene : arene %s pleine (%zu/%zu octets, %zu demandes)\n", arene->nom, arene->utilise, arene->taille, taille);
+        arene->pleine = SDL_TRUE;
+        return NULL;
     }
+    arene->utilise = debut + taille;
+    return arene->memoire + debut;
+}
 
-    /* destruction du renderer et de la fenetre, fermeture de la SDL puis sortie du programme */
-
-    if (NULL != all->renderer)
-        SDL_DestroyRenderer(all->renderer);
-    if (NULL != all->window)
-        SDL_DestroyWindow(all->window);
-    TTF_Quit();
-    SDL_Quit();
-    printf("Libérations de toutes les ressources réussies\n");
-    exit(statut);
+void resetArene(Arene *arene)
+{
+    /* O(1) : tout ce qui a ete pris dans l'arene est rendu d'un coup, la memoire reste reservee */
+    arene->utilise = 0;
 }
 
-void loadOptions(Everything *all)
+void destroyArene(Arene *arene)
 {
-    all->input.key_A = SDLK_SPACE;
-    all->input.key_B = SDLK_d;
-    all->input.key_down = SDLK_KP_8;
-    all->input.key_L = SDLK_a;
-    all->input.key_left = SDLK_KP_7;
-    all->input.key_R = SDLK_z;
-    all->input.key_right = SDLK_KP_9;
-    all->input.key_select = SDLK_e;
-    all->input.key_start = SDLK_RETURN;
-    all->input.key_up = SDLK_KP_DIVIDE;
-    all->input.select_on_cooldown = SDL_FALSE;
-    all->input.start_on_cooldown = SDL_FALSE;
+    SDL_free(arene->memoire);
+    arene->memoire = NULL;
+    arene->taille = 0;
+    arene->utilise = 0;
 }
 
-FirePlayer *loadFirePlayer(Everything *all)
+void createPool(Pool *pool, const char nom[], size_t taille_bloc, int capacite, Arene *arene)
 {
-    FirePlayer *last = &all->liste_fireplayer;
-    while (last->suivant != NULL)
-    {
-        last = last->suivant;
+    /* capacite blocs reserves d'un coup, ou pris dans arene au premier reprendPool si elle est donnee ;
+       les blocs sont ensuite distribues par increment (nb_neufs) puis recycles par une free-list.
+       Les generations restent hors de l'arene pour survivre a resetArene */
+    if (taille_bloc < sizeof(void *))
+    {
+        taille_bloc = sizeof(void *);
+    }
+    pool->nom = nom;
+    pool->arene = arene;
+    pool->taille_bloc = taille_bloc;
+    pool->capacite = 0;
+    pool->nb_neufs = 0;
+    pool->nb_utilises = 0;
+    pool->nb_max_utilises = 0;
+    pool->nb_refus = 0;
+    pool->nb_allocations = 0;
+    pool->libres = NULL;
+    pool->memoire = (arene != NULL) ? NULL : SDL_malloc(taille_bloc * capacite);
+    pool->generations = SDL_malloc(capacite * sizeof(Uint32));
+    if ((arene == NULL && pool->memoire == NULL) || pool->generations == NULL)
+    {
+        fprintf(stderr, "Erreur dans createPool : impossible d'allouer le pool %s\n", nom);
+        if (arene == NULL)
+        {
+            SDL_free(pool->memoire);
+        }
+        SDL_free(pool->generations);
+        pool->memoire = NULL;
+        pool->generations = NULL;
+        return;
     }
-    last->suivant = SDL_malloc(sizeof(FirePlayer));
-    last->suivant->texture = loadImage("data/fire_player.bmp", all->renderer);
-    last->suivant->x = 0;
-    last->suivant->y = 0;
-    last->suivant->src_rect.h = 16;
-    last->suivant->src_rect.w = 16;
-    last->suivant->src_rect.x = 0;
-    last->suivant->src_rect.y = 0;
-    last->suivant->dst_rect.h = 16;
-    last->suivant->dst_rect.w = 16;
-    last->suivant->dst_rect.x = -8;
-    last->suivant->dst_rect.y = -8;
-    last->suivant->suivant = NULL;
-    last->suivant->hitbox.cercle_x = 0;
-    last->suivant->hitbox.cercle_y = 0;
-    last->suivant->hitbox.cercle_rayon = 10;
-    last->suivant->hitbox.nb_points = 4;
-    SDL_Point points[4];
-    last->suivant->hitbox.points = SDL_malloc(sizeof(points));
-    last->suivant->hitbox.points[0].x = -2;
-    last->suivant->hitbox.points[0].y = -3;
-    last->suivant->hitbox.points[1].x = 2;
-    last->suivant->hitbox.points[1].y = -3;
-    last->suivant->hitbox.points[2].x = 2;
-    last->suivant->hitbox.points[2].y = 3;
-    last->suivant->hitbox.points[3].x = -2;
-    last->suivant->hitbox.points[3].y = 3;
-    return last->suivant;
+    pool->capacite = capacite;
+    SDL_memset(pool->generations, 0, capacite * sizeof(Uint32));
 }
 
-void movePlayer(int x, int y, Everything *all)
+void *allocPool(Pool *pool)
 {
-    all->player.x += x;
-    all->player.dst_rect.x += x;
-    all->player.hitbox.cercle_x += x;
-    for (int i = 0; i < all->player.hitbox.nb_points; i++)
+    /* O(1), sans malloc ; si le pool est plein on refuse l'allocation (NULL) et l'appelant abandonne le spawn */
+    void *bloc = pool->libres;
+    int indice;
+    if (bloc != NULL)
     {
-        all->player.hitbox.points[i].x += x;
+        pool->libres = *(void **)bloc;
     }
-    for (int i = 0; i < all->level.nb_hitboxes; i++)
+    else if (pool->nb_neufs < pool->capacite)
     {
-        if (sat(&all->player.hitbox, &all->level.hitboxes[i]))
+        /* bloc jamais sorti depuis le dernier resetPool : sa generation change pour perimer les anciennes poignees */
+        indice = pool->nb_neufs++;
+        bloc = pool->memoire + indice * pool->taille_bloc;
+        pool->generations[indice] += 1;
+        if (pool->generations[indice] == 0)
         {
-            all->player.x -= x;
-            all->player.dst_rect.x -= x;
-            all->player.hitbox.cercle_x -= x;
-            for (int j = 0; j < all->player.hitbox.nb_points; j++)
-            {
-                all->player.hitbox.points[j].x -= x;
-            }
-            break;
+            pool->generations[indice] = 1;
+        }
+    }
+    else
+    {
+        if (pool->nb_refus == 0)
+        {
+            fprintf(stderr, "Erreur dans allocPool : pool %s plein (%d blocs), les allocations suivantes sont refusees\n", pool->nom, pool->capacite);
         }
+        pool->nb_refus += 1;
+        return NULL;
     }
+    pool->nb_utilises += 1;
+    pool->nb_allocations += 1;
+    if (pool->nb_utilises > pool->nb_max_utilises)
+    {
+        pool->nb_max_utilises = pool->nb_utilises;
+    }
+    return bloc;
+}
 
-    all->player.y += y;
-    all->player.dst_rect.y += y;
-    all->player.hitbox.cercle_y += y;
-    for (int i = 0; i < all->player.hitbox.nb_points; i++)
+void freePool(Pool *pool, void *bloc)
+{
+    size_t indice;
+    if (bloc == NULL)
     {
-        all->player.hitbox.points[i].y += y;
+        return;
     }
-    for (int i = 0; i < all->level.nb_hitboxes; i++)
+    /* les poignees prises sur ce bloc ne le designent plus */
+    indice = ((char *)bloc - pool->memoire) / pool->taille_bloc;
+    pool->generations[indice] += 1;
+    if (pool->generations[indice] == 0)
     {
-        if (sat(&all->player.hitbox, &all->level.hitboxes[i]))
-        {
-            all->player.y -= y;
-            all->player.dst_rect.y -= y;
-            all->player.hitbox.cercle_y -= y;
-            for (int j = 0; j < all->player.hitbox.nb_points; j++)
-            {
-                all->player.hitbox.points[j].y -= y;
-            }
-            break;
-        }
+        pool->generations[indice] = 1;
     }
+    *(void **)bloc = pool->libres;
+    pool->libres = bloc;
+    pool->nb_utilises -= 1;
+}
+
+void resetPool(Pool *pool)
+{
+    /* O(1) : tous les blocs redeviennent libres d'un coup, sans parcourir ceux qui etaient encore utilises */
+    pool->libres = NULL;
+    pool->nb_neufs = 0;
+    pool->nb_utilises = 0;
 }
 
-void moveFirePlayer(int x, int y, FirePlayer *fire, Everything *all)
+void reprendPool(Pool *pool)
 {
-    fire->y += y;
-    fire->x += x;
-    fire->dst_rect.y += y;
-    fire->dst_rect.x += x;
-    fire->hitbox.cercle_y += y;
-    fire->hitbox.cercle_x += x;
-    for (int i = 0; i < fire->hitbox.nb_points; i++)
+    /* apres resetArene : les blocs sont retailles dans l'arene, tous libres ; les generations, elles,
+       continuent d'augmenter et perimeront les poignees prises avant */
+    resetPool(pool);
+    if (pool->arene == NULL || pool->generations == NULL)
     {
-        fire->hitbox.points[i].y += y;
-        fire->hitbox.points[i].x += x;
+        return;
     }
+    pool->memoire = allocArene(pool->arene, pool->taille_bloc * pool->capacite);
 }
 
-void moveMob(int x, int y, Mob *mob, Everything *all)
+void destroyPool(Pool *pool)
 {
-    mob->y += y;
-    mob->x += x;
-    mob->dst_rect.y += y;
-    mob->dst_rect.x += x;
-    mob->hitbox.cercle_y += y;
-    mob->hitbox.cercle_x += x;
-    for (int i = 0; i < mob->hitbox.nb_points; i++)
+    if (pool->generations == NULL)
+    {
+        return;
+    }
+    printf("Pool %s : %d/%d blocs au maximum, %d allocations refusees\n", pool->nom, pool->nb_max_utilises, pool->capacite, pool->nb_refus);
+    if (pool->arene == NULL)
     {
-        mob->hitbox.points[i].y += y;
-        mob->hitbox.points[i].x += x;
+        SDL_free(pool->memoire);
     }
+    SDL_free(pool->generations);
+    pool->memoire = NULL;
+    pool->generations = NULL;
+    pool->libres = NULL;
+    pool->capacite = 0;
+    pool->nb_neufs = 0;
 }
 
-Mob *loadMob(Everything *all)
+Poignee poigneePool(Pool *pool, void *bloc)
 {
-    Mob *last = &all->liste_mob;
-    while (last->suivant != NULL)
+    /* poignee d'un bloc alloue ; NULL donne la poignee nulle */
+    Poignee poignee = {0, 0};
+    if (bloc != NULL)
     {
-        last = last->suivant;
+        poignee.indice = (Uint32)(((char *)bloc - pool->memoire) / pool->taille_bloc);
+        poignee.generation = pool->generations[poignee.indice];
     }
-    last->suivant = SDL_malloc(sizeof(Mob));
-    last->suivant->texture = loadImage("data/ship_mob.bmp", all->renderer);
-    last->suivant->src_rect.h = 16;
-    last->suivant->src_rect.w = 16;
-    last->suivant->src_rect.x = 0;
-    last->suivant->src_rect.y = 0;
-    last->suivant->dst_rect.h = 16;
-    last->suivant->dst_rect.w = 16;
-    last->suivant->dst_rect.x = -8;
-    last->suivant->dst_rect.y = -8;
-    last->suivant->x = 0;
-    last->suivant->y = 0;
-    last->suivant->suivant = NULL;
-    last->suivant->PV = 1;
-    last->suivant->hitbox.cercle_x = 0;
-    last->suivant->hitbox.cercle_y = 0;
-    last->suivant->hitbox.cercle_rayon = 10;
-    last->suivant->hitbox.nb_points = 4;
-    SDL_Point points[4];
-    last->suivant->hitbox.points = SDL_malloc(sizeof(points));
-    last->suivant->hitbox.points[0].x = -6;
-    last->suivant->hitbox.points[0].y = -7;
-    last->suivant->hitbox.points[1].x = 6;
-    last->suivant->hitbox.points[1].y = -7;
-    last->suivant->hitbox.points[2].x = 6;
-    last->suivant->hitbox.points[2].y = 7;
-    last->suivant->hitbox.points[3].x = -6;
-    last->suivant->hitbox.points[3].y = 7;
-    return last->suivant;
+    return poignee;
 }
 
-void spawnMobs(Everything *all)
+void *resolvePool(Pool *pool, Poignee poignee)
 {
-    Mob *mob = loadMob(all);
-    moveMob(160, 20, mob, all);
-    mob = loadMob(all);
-    moveMob(80, 20, mob, all);
-    mob = loadMob(all);
-    moveMob(240, 20, mob, all);
+    /* O(1) : le bloc, ou NULL si la poignee est nulle ou perimee (bloc libere ou pool remis a zero depuis, meme s'il a ete realloue) */
+    if (poignee.generation == 0 || poignee.indice >= (Uint32)pool->nb_neufs || pool->generations[poignee.indice] != poignee.generation)
+    {
+        return NULL;
+    }
+    return pool->memoire + poignee.indice * pool->taille_bloc;
 }
 
-void firePlayer(Everything *all)
+Poignee poigneeMob(Mob *mob, Everything *all)
 {
-    FirePlayer *fire = loadFirePlayer(all);
-    moveFirePlayer(all->player.x, all->player.y, fire, all);
-    all->player.delay_fire = 10;
+    return poigneePool(&all->pool_mobs, mob);
 }
 
-void loadPlayer(Everything *all)
+Mob *resolveMob(Poignee poignee, Everything *all)
 {
-    all->player.texture = loadImage("data/ship_player.bmp", all->renderer);
-    all->player.src_rect.h = 16;
-    all->player.src_rect.w = 16;
-    all->player.src_rect.x = 0;
-    all->player.src_rect.y = 0;
-    all->player.dst_rect.h = 16;
-    all->player.dst_rect.w = 16;
-    all->player.dst_rect.x = 152;
-    all->player.dst_rect.y = 172;
-    all->player.x = 160;
-    all->player.y = 180;
-    all->player.hitbox.cercle_x = 160;
-    all->player.hitbox.cercle_y = 180;
-    all->player.hitbox.cercle_rayon = 10;
-    all->player.hitbox.nb_points = 4;
-    SDL_Point points[4];
-    all->player.hitbox.points = SDL_malloc(sizeof(points));
-    all->player.hitbox.points[0].x = 154;
-    all->player.hitbox.points[0].y = 173;
-    all->player.hitbox.points[1].x = 166;
-    all->player.hitbox.points[1].y = 173;
-    all->player.hitbox.points[2].x = 166;
-    all->player.hitbox.points[2].y = 187;
-    all->player.hitbox.points[3].x = 154;
-    all->player.hitbox.points[3].y = 187;
-    all->player.PV = 5;
-    all->player.delay_fire = 0;
-    all->player.invincibility_frames = 0;
+    /* un mob tue mais pas encore balaye par sweepMobs ne se resout deja plus */
+    Mob *mob = resolvePool(&all->pool_mobs, poignee);
+    return (mob != NULL && !mob->mort) ? mob : NULL;
+}
+
+Poignee poigneeFirePlayer(FirePlayer *fire, Everything *all)
+{
+    return poigneePool(&all->pool_fireplayers, fire);
+}
+
+FirePlayer *resolveFirePlayer(Poignee poignee, Everything *all)
+{
+    FirePlayer *fire = resolvePool(&all->pool_fireplayers, poignee);
+    return (fire != NULL && !fire->mort) ? fire : NULL;
+}
+
+void initFormeHitbox(FormeHitbox *forme, const SDL_Point points[], int nb_points)
+{
+    /* precalcule les normales, la projection de la forme sur chacune, son rectangle et son
+       cercle englobants : le centre du cercle est l'origine locale, donc la position de l'entite */
+    int p, distance, distance_max = 0, suivant;
+    if (nb_points > NB_POINTS_MAX_FORME)
+    {
+        fprintf(stderr, "Erreur dans initFormeHitbox : %d points, %d au maximum\n", nb_points, NB_POINTS_MAX_FORME);
+        nb_points = NB_POINTS_MAX_FORME;
+    }
+    forme->nb_points = nb_points;
+    forme->min_x = points[0].x;
+    forme->max_x = points[0].x;
+    forme->min_y = points[0].y;
+    forme->max_y = points[0].y;
+    for (int i = 0; i < nb_points; i++)
+    {
+        forme->points[i] = points[i];
+        forme->min_x = SDL_min(forme->min_x, points[i].x);
+        forme->max_x = SDL_max(forme->max_x, points[i].x);
+        forme->min_y = SDL_min(forme->min_y, points[i].y);
+        forme->max_y = SDL_max(forme->max_y, points[i].y);
+        distance = points[i].x * points[i].x + points[i].y * points[i].y;
+        distance_max = SDL_max(distance_max, distance);
+    }
+    forme->cercle_rayon = (int)SDL_sqrt(distance_max);
+    while (forme->cercle_rayon * forme->cercle_rayon < distance_max)
+    {
+        forme->cercle_rayon += 1;
+    }
+    for (int i = 0; i < nb_points; i++)
+    {
+        suivant = (i + 1 >= nb_points) ? 0 : i + 1;
+        forme->normales[i].x = -(points[i].y - points[suivant].y);
+        forme->normales[i].y = points[i].x - points[suivant].x;
+        forme->projection_min[i] = forme->normales[i].x * points[0].x + forme->normales[i].y * points[0].y;
+        forme->projection_max[i] = forme->projection_min[i];
+        for (int j = 1; j < nb_points; j++)
+        {
+            p = forme->normales[i].x * points[j].x + forme->normales[i].y * points[j].y;
+            forme->projection_min[i] = SDL_min(forme->projection_min[i], p);
+            forme->projection_max[i] = SDL_max(forme->projection_max[i], p);
+        }
+    }
+}
+
+void initFormeRectangle(FormeHitbox *forme, int demi_largeur, int demi_hauteur)
+{
+    SDL_Point points[4] = {{-demi_largeur, -demi_hauteur}, {demi_largeur, -demi_hauteur},
+                           {demi_largeur, demi_hauteur}, {-demi_largeur, demi_hauteur}};
+    initFormeHitbox(forme, points, 4);
+}
+
+void loadFormes(Everything *all)
+{
+    initFormeRectangle(&all->formes.mob, 6, 7);
+    initFormeRectangle(&all->formes.fireplayer, 2, 3);
+    initFormeRectangle(&all->formes.player, 6, 7);
+}
+
+
+int packArchive(const char *chemins[], int nb)
+{
+    /* outil hors jeu : concatene les fichiers lus par le jeu derriere un index ; un fichier
+       absent est ignore (l'atlas n'existe que si --pack-atlas a ete lance avant) */
+    SDL_RWops *sortie = NULL, *fichier;
+    Uint8 **contenus = SDL_calloc(nb, sizeof(Uint8 *));
+    Uint32 *tailles = SDL_calloc(nb, sizeof(Uint32));
+    Uint32 position = 8;
+    int i, nb_entrees = 0, statut = EXIT_FAILURE;
+    Sint64 taille;
+    const Uint8 zeros[ALIGNEMENT_ARCHIVE] = {0};
+    if (contenus == NULL || tailles == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_malloc : impossible de preparer l'archive\n");
+        goto fin;
+    }
+    for (i = 0; i < nb; i++)
+    {
+        if (SDL_strlen(chemins[i]) >= sizeof(((EntreeArchive *)NULL)->chemin))
+        {
+            fprintf(stderr, "Erreur dans packArchive : chemin trop long (%s)\n", chemins[i]);
+            goto fin;
+        }
+        fichier = SDL_RWFromFile(chemins[i], "rb");
+        if (fichier == NULL)
+        {
+            printf("%s absent, ignore\n", chemins[i]);
+            continue;
+        }
+        taille = SDL_RWsize(fichier);
+        contenus[i] = (taille > 0) ? SDL_malloc(taille) : NULL;
+        if (contenus[i] == NULL || SDL_RWread(fichier, contenus[i], 1, taille) != (size_t)taille)
+        {
+            fprintf(stderr, "Erreur dans packArchive : lecture de %s impossible\n", chemins[i]);
+            SDL_RWclose(fichier);
+            goto fin;
+        }
+        SDL_RWclose(fichier);
+        tailles[i] = (Uint32)taille;
+        position += 1 + SDL_strlen(chemins[i]) + 8;
+        nb_entrees++;
+    }
+    sortie = SDL_RWFromFile(CHEMIN_ARCHIVE, "wb");
+    if (sortie == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_RWFromFile : %s\n", SDL_GetError());
+        goto fin;
+    }
+    SDL_RWwrite(sortie, "SSPK", 1, 4);
+    SDL_WriteLE16(sortie, ARCHIVE_VERSION);
+    SDL_WriteLE16(sortie, (Uint16)nb_entrees);
+    for (i = 0; i < nb; i++)
+    {
+        if (contenus[i] != NULL)
+        {
+            position = (position + ALIGNEMENT_ARCHIVE - 1) / ALIGNEMENT_ARCHIVE * ALIGNEMENT_ARCHIVE;
+            SDL_WriteU8(sortie, (Uint8)SDL_strlen(chemins[i]));
+            SDL_RWwrite(sortie, chemins[i], 1, SDL_strlen(chemins[i]));
+            SDL_WriteLE32(sortie, position);
+            SDL_WriteLE32(sortie, tailles[i]);
+            printf("%s -> %u octets en %u\n", chemins[i], tailles[i], position);
+            position += tailles[i];
+        }
+    }
+    for (i = 0; i < nb; i++)
+    {
+        if (contenus[i] != NULL)
+        {
+            SDL_RWwrite(sortie, zeros, 1, (ALIGNEMENT_ARCHIVE - SDL_RWtell(sortie) % ALIGNEMENT_ARCHIVE) % ALIGNEMENT_ARCHIVE);
+            SDL_RWwrite(sortie, contenus[i], 1, tailles[i]);
+        }
+    }
+    printf("Archive de %d fichiers (%u octets) ecrite dans %s\n", nb_entrees, position, CHEMIN_ARCHIVE);
+    statut = EXIT_SUCCESS;
+
+fin:
+    if (sortie != NULL)
+    {
+        SDL_RWclose(sortie);
+    }
+    for (i = 0; contenus != NULL && i < nb; i++)
+    {
+        SDL_free(contenus[i]);
+    }
+    SDL_free(contenus);
+    SDL_free(tailles);
+    return statut;
+}
+
+void loadArchive(void)
+{
+    /* projette l'archive en memoire (lecture d'un bloc sans mmap) puis lit son index ;
+       sans archive valide, openAsset se rabat sur les fichiers separes */
+    SDL_RWops *index;
+    char magique[4];
+    Uint8 longueur;
+    Sint64 taille;
+    Uint8 *donnees;
+#ifdef ARCHIVE_MMAP
+    struct stat infos;
+    void *projection;
+    int descripteur = open(CHEMIN_ARCHIVE, O_RDONLY);
+    if (descripteur >= 0)
+    {
+        if (fstat(descripteur, &infos) == 0 && infos.st_size > 0)
+        {
+            projection = mmap(NULL, infos.st_size, PROT_READ, MAP_PRIVATE, descripteur, 0);
+            if (projection != MAP_FAILED)
+            {
+                archive.donnees = projection;
+                archive.taille = infos.st_size;
+                archive.projetee = SDL_TRUE;
+            }
+        }
+        close(descripteur);
+    }
+#endif
+    if (archive.donnees == NULL)
+    {
+        index = SDL_RWFromFile(CHEMIN_ARCHIVE, "rb");
+        if (index == NULL)
+        {
+            return;
+        }
+        taille = SDL_RWsize(index);
+        donnees = (taille > 0) ? SDL_malloc(taille) : NULL;
+        if (donnees != NULL && SDL_RWread(index, donnees, 1, taille) == (size_t)taille)
+        {
+            archive.donnees = donnees;
+            archive.taille = taille;
+        }
+        else
+        {
+            SDL_free(donnees);
+        }
+        SDL_RWclose(index);
+        if (archive.donnees == NULL)
+        {
+            return;
+        }
+    }
+    index = SDL_RWFromConstMem(archive.donnees, (int)archive.taille);
+    if (SDL_RWread(index, magique, 1, 4) != 4 || SDL_memcmp(magique, "SSPK", 4) != 0
+        || SDL_ReadLE16(index) != ARCHIVE_VERSION)
+    {
+        fprintf(stderr, "Erreur loadArchive : %s n'est pas une archive de version %d\n", CHEMIN_ARCHIVE, ARCHIVE_VERSION);
+        SDL_RWclose(index);
+        return;
+    }
+    archive.nb = SDL_ReadLE16(index);
+    archive.entrees = SDL_calloc(archive.nb, sizeof(EntreeArchive));
+    if (archive.entrees == NULL)
+    {
+        archive.nb = 0;
+        SDL_RWclose(index);
+        return;
+    }
+    for (int i = 0; i < archive.nb; i++)
+    {
+        longueur = SDL_ReadU8(index);
+        if (longueur >= sizeof(archive.entrees[i].chemin) || SDL_RWread(index, archive.entrees[i].chemin, 1, longueur) != longueur)
+        {
+            fprintf(stderr, "Erreur loadArchive : index de %s tronque\n", CHEMIN_ARCHIVE);
+            archive.nb = i;
+            break;
+        }
+        archive.entrees[i].chemin[longueur] = '\0';
+        archive.entrees[i].position = SDL_ReadLE32(index);
+        archive.entrees[i].taille = SDL_ReadLE32(index);
+        if ((Uint64)archive.entrees[i].position + archive.entrees[i].taille > archive.taille)
+        {
+            fprintf(stderr, "Erreur loadArchive : %s depasse la fin de %s\n", archive.entrees[i].chemin, CHEMIN_ARCHIVE);
+            archive.nb = i;
+            break;
+        }
+    }
+    SDL_RWclose(index);
+}
+
+void destroyArchive(void)
+{
+    if (archive.donnees == NULL)
+    {
+        return;
+    }
+    printf("Archive %s : %d ressources, %s\n", CHEMIN_ARCHIVE, archive.nb,
+           archive.projetee ? "projetee en memoire" : "lue en memoire");
+#ifdef ARCHIVE_MMAP
+    if (archive.projetee)
+    {
+        munmap((void *)archive.donnees, archive.taille);
+    }
+#endif
+    if (!archive.projetee)
+    {
+        SDL_free((void *)archive.donnees);
+    }
+    SDL_free(archive.entrees);
+    archive.donnees = NULL;
+    archive.entrees = NULL;
+    archive.nb = 0;
+}
+
+SDL_RWops *openAsset(const char chemin[])
+{
+    /* ressource du jeu : lue sans copie dans l'archive si elle y est, sinon depuis son fichier ;
+       la memoire de l'archive reste valide jusqu'a destroyArchive, apres la fermeture des polices */
+    for (int i = 0; i < archive.nb; i++)
+    {
+        if (SDL_strcmp(archive.entrees[i].chemin, chemin) == 0)
+        {
+            return SDL_RWFromConstMem(archive.donnees + archive.entrees[i].position, (int)archive.entrees[i].taille);
+        }
+    }
+    return SDL_RWFromFile(chemin, "rb");
+}
+
+SDL_Texture *loadSurface(SDL_Surface *surface, SDL_Renderer *renderer)
+{
+    /* envoie une surface deja decodee au GPU ; la surface reste a l'appelant */
+    SDL_Texture *texture = NULL, *tmp = NULL;
+    tmp = SDL_CreateTextureFromSurface(renderer, surface);
+    if(NULL == tmp)
+    {
+        fprintf(stderr, "Erreur SDL_CreateTextureFromSurface : %s\n", SDL_GetError());
+        return NULL;
+    }
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, 
+                            SDL_TEXTUREACCESS_TARGET, surface->w, surface->h);
+    if(NULL == texture)
+    {
+        fprintf(stderr, "Erreur SDL_CreateTexture : %s\n", SDL_GetError());
+        SDL_DestroyTexture(tmp);
+        return NULL;
+    }
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_RenderCopy(renderer, tmp, NULL, NULL);
+    SDL_DestroyTexture(tmp);
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+SDL_Texture *loadImage(const char chemin[], SDL_Renderer *renderer)
+{
+    SDL_Surface *surface = NULL; 
+    SDL_Texture *texture = NULL;
+    surface = SDL_LoadBMP_RW(openAsset(chemin), 1);
+    if(NULL == surface)
+    {
+        fprintf(stderr, "Erreur SDL_LoadBMP : %s\n", SDL_GetError());
+        return NULL;
+    }
+    texture = loadSurface(surface, renderer);
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+CachedTexture *cacheTexture(const char chemin[], SDL_Texture *texture, Everything *all)
+{
+    /* ajoute une texture deja creee au cache, sans reference : le premier acquireTexture la trouvera */
+    CachedTexture *cached = &all->textures.liste_texture;
+    while (cached->suivant != NULL)
+    {
+        cached = cached->suivant;
+    }
+    cached->suivant = SDL_malloc(sizeof(CachedTexture));
+    SDL_strlcpy(cached->suivant->chemin, chemin, sizeof(cached->suivant->chemin));
+    cached->suivant->texture = texture;
+    cached->suivant->nb_references = 0;
+    cached->suivant->suivant = NULL;
+    return cached->suivant;
+}
+
+SDL_Texture *acquireTexture(const char chemin[], Everything *all)
+{
+    /* renvoie la texture partagee associee a chemin, en la chargeant au premier appel */
+    CachedTexture *cached = &all->textures.liste_texture;
+    if (all->renderer == NULL)
+    {
+        /* mode headless : les entites n'ont pas de texture */
+        return NULL;
+    }
+    while (cached->suivant != NULL)
+    {
+        if (SDL_strcmp(cached->suivant->chemin, chemin) == 0)
+        {
+            cached->suivant->nb_references += 1;
+            all->textures.nb_hits += 1;
+            return cached->suivant->texture;
+        }
+        cached = cached->suivant;
+    }
+    all->textures.nb_misses += 1;
+    if (SDL_strlen(chemin) >= sizeof(cached->chemin))
+    {
+        fprintf(stderr, "Erreur dans acquireTexture : chemin trop long pour le cache (%s)\n", chemin);
+        return NULL;
+    }
+    DEBUT_TRACE(&all->trace, "loadImage");
+    SDL_Texture *texture = loadImage(chemin, all->renderer);
+    FIN_TRACE(&all->trace);
+    if (texture == NULL)
+    {
+        return NULL;
+    }
+    cacheTexture(chemin, texture, all)->nb_references = 1;
+    return texture;
+}
+
+void releaseTexture(SDL_Texture *texture, Everything *all)
+{
+    /* la texture reste en cache meme sans reference : le prochain spawn ne relit pas le fichier */
+    CachedTexture *cached = all->textures.liste_texture.suivant;
+    if (texture == NULL)
+    {
+        return;
+    }
+    while (cached != NULL)
+    {
+        if (cached->texture == texture)
+        {
+            if (cached->nb_references > 0)
+            {
+                cached->nb_references -= 1;
+            }
+            return;
+        }
+        cached = cached->suivant;
+    }
+    fprintf(stderr, "Erreur dans releaseTexture : la texture n'appartient pas au cache\n");
+}
+
+void destroyTextureCache(Everything *all)
+{
+    CachedTexture *cached = all->textures.liste_texture.suivant, *tmp = NULL;
+    printf("Cache de textures : %d hits, %d misses\n", all->textures.nb_hits, all->textures.nb_misses);
+    while (cached != NULL)
+    {
+        if (cached->nb_references > 0)
+        {
+            fprintf(stderr, "Erreur dans destroyTextureCache : %s encore utilisee %d fois\n", cached->chemin, cached->nb_references);
+        }
+        if (cached->texture != NULL)
+        {
+            SDL_DestroyTexture(cached->texture);
+        }
+        tmp = cached->suivant;
+        SDL_free(cached);
+        cached = tmp;
+    }
+    all->textures.liste_texture.suivant = NULL;
+}
+
+int packAtlas(const char *chemins[], int nb)
+{
+    /* outil hors jeu : range les images par etageres (les plus hautes d'abord) dans une seule
+       image, puis ecrit l'image et l'index des sous-rectangles */
+    SDL_Surface **images = SDL_calloc(nb, sizeof(SDL_Surface *)), *atlas = NULL, *image;
+    SDL_Rect *rects = SDL_malloc(nb * sizeof(SDL_Rect));
+    int *ordre = SDL_malloc(nb * sizeof(int));
+    int largeur = 0, x = 0, y = 0, hauteur_etagere = 0, statut = EXIT_FAILURE, i, j, tmp;
+    SDL_RWops *index = NULL;
+    if (images == NULL || rects == NULL || ordre == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_malloc : impossible de preparer l'atlas\n");
+        goto fin;
+    }
+    for (i = 0; i < nb; i++)
+    {
+        if (SDL_strlen(chemins[i]) >= sizeof(((EntreeAtlas *)NULL)->chemin))
+        {
+            fprintf(stderr, "Erreur dans packAtlas : chemin trop long (%s)\n", chemins[i]);
+            goto fin;
+        }
+        image = SDL_LoadBMP(chemins[i]);
+        if (image == NULL)
+        {
+            fprintf(stderr, "Erreur SDL_LoadBMP : %s\n", SDL_GetError());
+            goto fin;
+        }
+        images[i] = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(image);
+        if (images[i] == NULL)
+        {
+            fprintf(stderr, "Erreur SDL_ConvertSurfaceFormat : %s\n", SDL_GetError());
+            goto fin;
+        }
+        if (images[i]->w > largeur)
+        {
+            largeur = images[i]->w;
+        }
+        ordre[i] = i;
+    }
+    for (i = 1; i < nb; i++)
+    {
+        for (j = i; j > 0 && images[ordre[j]]->h > images[ordre[j - 1]]->h; j--)
+        {
+            tmp = ordre[j];
+            ordre[j] = ordre[j - 1];
+            ordre[j - 1] = tmp;
+        }
+    }
+    for (i = 0; i < nb; i++)
+    {
+        image = images[ordre[i]];
+        if (x + image->w > largeur)
+        {
+            y += hauteur_etagere + MARGE_ATLAS;
+            x = 0;
+            hauteur_etagere = 0;
+        }
+        rects[ordre[i]].x = x;
+        rects[ordre[i]].y = y;
+        rects[ordre[i]].w = image->w;
+        rects[ordre[i]].h = image->h;
+        x += image->w + MARGE_ATLAS;
+        if (image->h > hauteur_etagere)
+        {
+            hauteur_etagere = image->h;
+        }
+    }
+    atlas = SDL_CreateRGBSurfaceWithFormat(0, largeur, y + hauteur_etagere, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_CreateRGBSurfaceWithFormat : %s\n", SDL_GetError());
+        goto fin;
+    }
+    SDL_FillRect(atlas, NULL, 0);
+    for (i = 0; i < nb; i++)
+    {
+        SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(images[i], NULL, atlas, &rects[i]);
+    }
+    if (SDL_SaveBMP(atlas, CHEMIN_ATLAS_IMAGE) != 0)
+    {
+        fprintf(stderr, "Erreur SDL_SaveBMP : %s\n", SDL_GetError());
+        goto fin;
+    }
+    index = SDL_RWFromFile(CHEMIN_ATLAS_INDEX, "wb");
+    if (index == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_RWFromFile : %s\n", SDL_GetError());
+        goto fin;
+    }
+    SDL_RWwrite(index, "SSAT", 1, 4);
+    SDL_WriteLE16(index, ATLAS_VERSION);
+    SDL_WriteLE16(index, (Uint16)nb);
+    for (i = 0; i < nb; i++)
+    {
+        SDL_WriteU8(index, (Uint8)SDL_strlen(chemins[i]));
+        SDL_RWwrite(index, chemins[i], 1, SDL_strlen(chemins[i]));
+        SDL_WriteLE16(index, (Uint16)rects[i].x);
+        SDL_WriteLE16(index, (Uint16)rects[i].y);
+        SDL_WriteLE16(index, (Uint16)rects[i].w);
+        SDL_WriteLE16(index, (Uint16)rects[i].h);
+        printf("%s -> (%d, %d) %dx%d\n", chemins[i], rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+    }
+    SDL_RWclose(index);
+    printf("Atlas %dx%d ecrit dans %s et %s\n", atlas->w, atlas->h, CHEMIN_ATLAS_IMAGE, CHEMIN_ATLAS_INDEX);
+    statut = EXIT_SUCCESS;
+
+fin:
+    if (atlas != NULL)
+    {
+        SDL_FreeSurface(atlas);
+    }
+    for (i = 0; images != NULL && i < nb; i++)
+    {
+        if (images[i] != NULL)
+        {
+            SDL_FreeSurface(images[i]);
+        }
+    }
+    SDL_free(images);
+    SDL_free(rects);
+    SDL_free(ordre);
+    return statut;
+}
+
+void loadAtlas(Everything *all)
+{
+    /* lit l'index de l'atlas s'il existe ; sans atlas chaque sprite garde son propre fichier */
+    Atlas *atlas = &all->atlas;
+    SDL_RWops *index = openAsset(CHEMIN_ATLAS_INDEX);
+    char magique[4];
+    Uint8 longueur;
+    atlas->nb = 0;
+    atlas->entrees = NULL;
+    if (index == NULL)
+    {
+        return;
+    }
+    if (SDL_RWread(index, magique, 1, 4) != 4 || SDL_memcmp(magique, "SSAT", 4) != 0
+        || SDL_ReadLE16(index) != ATLAS_VERSION)
+    {
+        fprintf(stderr, "Erreur loadAtlas : %s n'est pas un index d'atlas de version %d\n", CHEMIN_ATLAS_INDEX, ATLAS_VERSION);
+        SDL_RWclose(index);
+        return;
+    }
+    atlas->nb = SDL_ReadLE16(index);
+    atlas->entrees = SDL_calloc(atlas->nb, sizeof(EntreeAtlas));
+    if (atlas->entrees == NULL)
+    {
+        atlas->nb = 0;
+        SDL_RWclose(index);
+        return;
+    }
+    for (int i = 0; i < atlas->nb; i++)
+    {
+        longueur = SDL_ReadU8(index);
+        if (longueur >= sizeof(atlas->entrees[i].chemin) || SDL_RWread(index, atlas->entrees[i].chemin, 1, longueur) != longueur)
+        {
+            fprintf(stderr, "Erreur loadAtlas : index %s tronque\n", CHEMIN_ATLAS_INDEX);
+            atlas->nb = i;
+            break;
+        }
+        atlas->entrees[i].chemin[longueur] = '\0';
+        atlas->entrees[i].rect.x = SDL_ReadLE16(index);
+        atlas->entrees[i].rect.y = SDL_ReadLE16(index);
+        atlas->entrees[i].rect.w = SDL_ReadLE16(index);
+        atlas->entrees[i].rect.h = SDL_ReadLE16(index);
+    }
+    SDL_RWclose(index);
+}
+
+void destroyAtlas(Everything *all)
+{
+    SDL_free(all->atlas.entrees);
+    all->atlas.entrees = NULL;
+    all->atlas.nb = 0;
+}
+
+SDL_Texture *acquireSprite(const char chemin[], SDL_Rect *src_rect, Everything *all)
+{
+    /* si l'atlas contient chemin : texture de l'atlas et src_rect decale sur le sous-rectangle du sprite,
+       sinon texture du fichier seul et src_rect inchange */
+    for (int i = 0; i < all->atlas.nb; i++)
+    {
+        if (SDL_strcmp(all->atlas.entrees[i].chemin, chemin) == 0)
+        {
+            src_rect->x += all->atlas.entrees[i].rect.x;
+            src_rect->y += all->atlas.entrees[i].rect.y;
+            return acquireTexture(CHEMIN_ATLAS_IMAGE, all);
+        }
+    }
+    return acquireTexture(chemin, all);
+}
+
+Text *loadTextSurface(SDL_Surface *surface, Everything *all)
+{
+    /* cree le Text d'une surface deja rasterisee ; la surface reste a l'appelant */
+    SDL_Texture *texture = NULL;
+    Text *last = &all->liste_text;
+    while (last->suivant != NULL)
+    {
+        last = last->suivant;
+    }
+    texture = loadSurface(surface, all->renderer);
+    if (NULL == texture)
+    {
+        return NULL;
+    }
+    last->suivant = allocPool(&all->pool_texts);
+    if (last->suivant == NULL)
+    {
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    last->suivant->texture = texture;
+    last->suivant->src_rect.h = surface->h;
+    last->suivant->src_rect.w = surface->w;
+    last->suivant->src_rect.x = 0;
+    last->suivant->src_rect.y = 0;
+    last->suivant->dst_rect.h = surface->h;
+    last->suivant->dst_rect.w = surface->w;
+    last->suivant->dst_rect.x = 0;
+    last->suivant->dst_rect.y = 0;
+    last->suivant->x = 0;
+    last->suivant->y = 0;
+    last->suivant->suivant = NULL;
+    return last->suivant;
+}
+
+Text *loadText(TTF_Font *font, const char text[], SDL_Color color, Everything *all)
+{
+    SDL_Surface *surface = NULL; 
+    Text *loaded = NULL;
+    DEBUT_TRACE(&all->trace, "loadText");
+    surface = TTF_RenderText_Solid(font, text, color);
+    if(NULL == surface)
+    {
+        fprintf(stderr, "Erreur TTF_RenderText_Solid : %s\n", TTF_GetError());
+        FIN_TRACE(&all->trace);
+        return NULL;
+    }
+    loaded = loadTextSurface(surface, all);
+    SDL_FreeSurface(surface);
+    FIN_TRACE(&all->trace);
+    return loaded;
+}
+
+SDL_bool separeSurAxes(Hitbox *hitbox1, Hitbox *hitbox2)
+{
+    /* axes de hitbox1 : sa propre projection est precalculee dans la forme, il suffit de la decaler */
+    const FormeHitbox *forme1 = hitbox1->forme, *forme2 = hitbox2->forme;
+    int min1, max1, min2, max2, p, decalage;
+    SDL_Point normal;
+    for (int i = 0; i < forme1->nb_points; i++)
+    {
+        normal = forme1->normales[i];
+        decalage = normal.x * hitbox1->x + normal.y * hitbox1->y;
+        min1 = forme1->projection_min[i] + decalage;
+        max1 = forme1->projection_max[i] + decalage;
+        decalage = normal.x * hitbox2->x + normal.y * hitbox2->y;
+        min2 = normal.x * forme2->points[0].x + normal.y * forme2->points[0].y + decalage;
+        max2 = min2;
+        for (int j = 1; j < forme2->nb_points; j++)
+        {
+            p = normal.x * forme2->points[j].x + normal.y * forme2->points[j].y + decalage;
+            if (p < min2)
+            {
+                min2 = p;
+            }
+            else if (p > max2)
+            {
+                max2 = p;
+            }
+        }
+        if (min1 >= max2 || min2 >= max1)
+        {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool sat(Hitbox *hitbox1, Hitbox *hitbox2)
+{
+    int dx = hitbox1->x - hitbox2->x, dy = hitbox1->y - hitbox2->y;
+    int rayons = hitbox1->forme->cercle_rayon + hitbox2->forme->cercle_rayon;
+    compteurs_collision.nb_sat += 1;
+
+    if (dx * dx + dy * dy > rayons * rayons)
+    {
+        compteurs_collision.nb_rejets_cercle += 1;
+        return SDL_FALSE;
+    }
+    if (separeSurAxes(hitbox1, hitbox2) || separeSurAxes(hitbox2, hitbox1))
+    {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+void createGrille(Grille *grille, int capacite_objets, int capacite_entrees)
+{
+    grille->capacite_objets = capacite_objets;
+    grille->capacite_entrees = capacite_entrees;
+    grille->objets = SDL_malloc(capacite_objets * sizeof(void *));
+    grille->cellules = SDL_malloc(4 * capacite_objets * sizeof(int));
+    grille->candidats = SDL_malloc(capacite_objets * sizeof(int));
+    grille->entree_suivante = SDL_malloc(capacite_entrees * sizeof(int));
+    grille->entree_objet = SDL_malloc(capacite_entrees * sizeof(int));
+    if (grille->objets == NULL || grille->cellules == NULL || grille->candidats == NULL
+        || grille->entree_suivante == NULL || grille->entree_objet == NULL)
+    {
+        fprintf(stderr, "Erreur dans createGrille : allocation impossible\n");
+        grille->capacite_objets = 0;
+        grille->capacite_entrees = 0;
+    }
+    grille->nb_objets = 0;
+    for (int i = 0; i < NB_CELLULES_X * NB_CELLULES_Y; i++)
+    {
+        grille->tete[i] = -1;
+    }
+    grille->nb_entrees = 0;
+    grille->saturee = SDL_FALSE;
+}
+
+void destroyGrille(Grille *grille)
+{
+    SDL_free(grille->objets);
+    SDL_free(grille->cellules);
+    SDL_free(grille->candidats);
+    SDL_free(grille->entree_suivante);
+    SDL_free(grille->entree_objet);
+    grille->objets = NULL;
+    grille->cellules = NULL;
+    grille->candidats = NULL;
+    grille->entree_suivante = NULL;
+    grille->entree_objet = NULL;
+    grille->capacite_objets = 0;
+    grille->capacite_entrees = 0;
+    grille->nb_objets = 0;
+}
+
+void clearGrille(Grille *grille)
+{
+    for (int i = 0; i < NB_CELLULES_X * NB_CELLULES_Y; i++)
+    {
+        grille->tete[i] = -1;
+    }
+    grille->nb_objets = 0;
+    grille->nb_entrees = 0;
+    grille->saturee = SDL_FALSE;
+}
+
+void cellulesHitbox(Hitbox *hitbox, int *cx1, int *cy1, int *cx2, int *cy2)
+{
+    /* rectangle englobant de la forme, converti en cellules et ramene dans la grille :
+       deux polygones convexes qui se chevauchent partagent toujours au moins une cellule */
+    const FormeHitbox *forme = hitbox->forme;
+    *cx1 = SDL_clamp((hitbox->x + forme->min_x) / TAILLE_CELLULE, 0, NB_CELLULES_X - 1);
+    *cx2 = SDL_clamp((hitbox->x + forme->max_x) / TAILLE_CELLULE, 0, NB_CELLULES_X - 1);
+    *cy1 = SDL_clamp((hitbox->y + forme->min_y) / TAILLE_CELLULE, 0, NB_CELLULES_Y - 1);
+    *cy2 = SDL_clamp((hitbox->y + forme->max_y) / TAILLE_CELLULE, 0, NB_CELLULES_Y - 1);
+}
+
+void placeGrille(Grille *grille, int indice, void *objet, Hitbox *hitbox)
+{
+    /* n'ecrit que la case indice : des threads differents peuvent placer des objets differents */
+    int *cellules = &grille->cellules[4 * indice];
+    grille->objets[indice] = objet;
+    cellulesHitbox(hitbox, &cellules[0], &cellules[1], &cellules[2], &cellules[3]);
+}
+
+void chaineObjet(Grille *grille, int indice)
+{
+    /* ajoute l'objet deja place aux listes de ses cellules, en serie */
+    int *cellules = &grille->cellules[4 * indice];
+    int cellule;
+    if (grille->nb_entrees + (cellules[2] - cellules[0] + 1) * (cellules[3] - cellules[1] + 1) > grille->capacite_entrees)
+    {
+        /* plus de place pour les entrees : queryGrille renverra tous les objets */
+        grille->saturee = SDL_TRUE;
+        return;
+    }
+    for (int cy = cellules[1]; cy <= cellules[3]; cy++)
+    {
+        for (int cx = cellules[0]; cx <= cellules[2]; cx++)
+        {
+            cellule = cy * NB_CELLULES_X + cx;
+            grille->entree_objet[grille->nb_entrees] = indice;
+            grille->entree_suivante[grille->nb_entrees] = grille->tete[cellule];
+            grille->tete[cellule] = grille->nb_entrees;
+            grille->nb_entrees += 1;
+        }
+    }
+}
+
+void chaineGrille(Grille *grille)
+{
+    /* a appeler apres avoir place les grille->nb_objets premiers objets */
+    for (int i = 0; i < grille->nb_objets; i++)
+    {
+        chaineObjet(grille, i);
+    }
+}
+
+int insertGrille(Grille *grille, void *objet, Hitbox *hitbox)
+{
+    int indice;
+    if (grille->nb_objets >= grille->capacite_objets)
+    {
+        fprintf(stderr, "Erreur dans insertGrille : grille pleine (%d objets)\n", grille->capacite_objets);
+        return -1;
+    }
+    indice = grille->nb_objets;
+    grille->nb_objets += 1;
+    placeGrille(grille, indice, objet, hitbox);
+    chaineObjet(grille, indice);
+    return indice;
+}
+
+int queryGrilleCandidats(Grille *grille, Hitbox *hitbox, int candidats[])
+{
+    /* remplit candidats avec les indices (sans doublon) des objets partageant une cellule avec
+       hitbox, et renvoie leur nombre ; sans etat partage, donc appelable depuis plusieurs threads :
+       un objet n'est retenu que dans la premiere cellule visitee, le coin haut gauche de
+       l'intersection de son rectangle de cellules avec celui de la requete */
+    int cx1, cy1, cx2, cy2, nb = 0, objet;
+    int *cellules;
+    if (grille->saturee)
+    {
+        for (int i = 0; i < grille->nb_objets; i++)
+        {
+            candidats[nb++] = i;
+        }
+        return nb;
+    }
+    cellulesHitbox(hitbox, &cx1, &cy1, &cx2, &cy2);
+    for (int cy = cy1; cy <= cy2; cy++)
+    {
+        for (int cx = cx1; cx <= cx2; cx++)
+        {
+            for (int e = grille->tete[cy * NB_CELLULES_X + cx]; e != -1; e = grille->entree_suivante[e])
+            {
+                objet = grille->entree_objet[e];
+                cellules = &grille->cellules[4 * objet];
+                if (cx == SDL_max(cellules[0], cx1) && cy == SDL_max(cellules[1], cy1))
+                {
+                    candidats[nb++] = objet;
+                }
+            }
+        }
+    }
+    return nb;
+}
+
+int queryGrille(Grille *grille, Hitbox *hitbox)
+{
+    return queryGrilleCandidats(grille, hitbox, grille->candidats);
+}
+
+void destroyLot(LotHitbox *lot)
+{
+    SDL_free(lot->cercle_x);
+    SDL_free(lot->cercle_y);
+    SDL_free(lot->cercle_rayon);
+    for (int k = 0; k < NB_POINTS_LOT; k++)
+    {
+        SDL_free(lot->points_x[k]);
+        SDL_free(lot->points_y[k]);
+        lot->points_x[k] = NULL;
+        lot->points_y[k] = NULL;
+    }
+    SDL_free(lot->etiquettes);
+    SDL_free(lot->irreguliers);
+    SDL_free(lot->hitboxes);
+    SDL_free(lot->masque);
+    lot->cercle_x = NULL;
+    lot->cercle_y = NULL;
+    lot->cercle_rayon = NULL;
+    lot->etiquettes = NULL;
+    lot->irreguliers = NULL;
+    lot->hitboxes = NULL;
+    lot->masque = NULL;
+    lot->capacite = 0;
+    lot->nb = 0;
+}
+
+void clearLot(LotHitbox *lot)
+{
+    lot->nb = 0;
+    lot->nb_irreguliers = 0;
+}
+
+int addLot(LotHitbox *lot, Hitbox *hitbox, int etiquette)
+{
+    const FormeHitbox *forme = hitbox->forme;
+    int j = lot->nb;
+    if (j >= lot->capacite)
+    {
+        fprintf(stderr, "Erreur dans addLot : lot plein (%d hitboxes)\n", lot->capacite);
+        return -1;
+    }
+    lot->hitboxes[j] = hitbox;
+    lot->etiquettes[j] = etiquette;
+    lot->cercle_x[j] = hitbox->x;
+    lot->cercle_y[j] = hitbox->y;
+    lot->cercle_rayon[j] = forme->cercle_rayon;
+    if (forme->nb_points == NB_POINTS_LOT)
+    {
+        for (int k = 0; k < NB_POINTS_LOT; k++)
+        {
+            lot->points_x[k][j] = forme->points[k].x + hitbox->x;
+            lot->points_y[k][j] = forme->points[k].y + hitbox->y;
+        }
+    }
+    else
+    {
+        for (int k = 0; k < NB_POINTS_LOT; k++)
+        {
+            lot->points_x[k][j] = 0;
+            lot->points_y[k][j] = 0;
+        }
+        lot->irreguliers[lot->nb_irreguliers] = j;
+        lot->nb_irreguliers += 1;
+    }
+    lot->nb += 1;
+    return j;
+}
+
+SDL_bool hitLot(LotHitbox *lot, int j)
+{
+    return (lot->masque[j >> 5] & (1u << (j & 31))) ? SDL_TRUE : SDL_FALSE;
+}
+
+void axesHitbox(Hitbox *hitbox, AxesHitbox *axes)
+{
+    /* axes et projections precalcules de la forme, ramenes a la position de hitbox */
+    const FormeHitbox *forme = hitbox->forme;
+    int decalage;
+    axes->nb = forme->nb_points;
+    for (int i = 0; i < forme->nb_points; i++)
+    {
+        axes->x[i] = forme->normales[i].x;
+        axes->y[i] = forme->normales[i].y;
+        decalage = axes->x[i] * hitbox->x + axes->y[i] * hitbox->y;
+        axes->min[i] = forme->projection_min[i] + decalage;
+        axes->max[i] = forme->projection_max[i] + decalage;
+        axes->points_x[i] = forme->points[i].x + hitbox->x;
+        axes->points_y[i] = forme->points[i].y + hitbox->y;
+    }
+}
+
+void collideLotScalaire(Hitbox *hitbox, LotHitbox *lot, AxesHitbox *axes)
+{
+    /* axes pas utilises : sat() projette elle-meme, le parametre garde la signature commune des noyaux */
+    (void)axes;
+    for (int j = 0; j < lot->nb; j++)
+    {
+        if (sat(hitbox, lot->hitboxes[j]))
+        {
+            lot->masque[j >> 5] |= 1u << (j & 31);
+        }
+    }
+}
+
+#ifdef COLLISIONS_X86
+/* SSE2 n'a ni _mm_mullo_epi32 ni _mm_min_epi32/_mm_max_epi32 (SSE4.1) : on les emule */
+static CIBLE_SSE2 __m128i mulloSSE2(__m128i a, __m128i b)
+{
+    __m128i pairs = _mm_mul_epu32(a, b);
+    __m128i impairs = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(pairs, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(impairs, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static CIBLE_SSE2 __m128i minSSE2(__m128i a, __m128i b)
+{
+    __m128i masque = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(masque, b), _mm_andnot_si128(masque, a));
+}
+
+static CIBLE_SSE2 __m128i maxSSE2(__m128i a, __m128i b)
+{
+    __m128i masque = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(masque, a), _mm_andnot_si128(masque, b));
+}
+
+CIBLE_SSE2 void collideLotSSE2(Hitbox *hitbox, LotHitbox *lot, AxesHitbox *axes)
+{
+    /* 4 candidats par iteration, memes calculs entiers que sat() : resultats identiques */
+    __m128i tous = _mm_set1_epi32(-1);
+    __m128i qx = _mm_set1_epi32(hitbox->x), qy = _mm_set1_epi32(hitbox->y), qr = _mm_set1_epi32(hitbox->forme->cercle_rayon);
+    __m128i px[NB_POINTS_LOT], py[NB_POINTS_LOT];
+    __m128i separe, dx, dy, rayons, ax, ay, p, min1, max1, min2, max2;
+    Uint64 nb_rejets = 0;
+    Uint32 rejets;
+    for (int j = 0; j < lot->nb; j += 4)
+    {
+        dx = _mm_sub_epi32(qx, _mm_loadu_si128((const __m128i *)(lot->cercle_x + j)));
+        dy = _mm_sub_epi32(qy, _mm_loadu_si128((const __m128i *)(lot->cercle_y + j)));
+        rayons = _mm_add_epi32(qr, _mm_loadu_si128((const __m128i *)(lot->cercle_rayon + j)));
+        separe = _mm_cmpgt_epi32(_mm_add_epi32(mulloSSE2(dx, dx), mulloSSE2(dy, dy)), mulloSSE2(rayons, rayons));
+        /* rejets par les cercles comptes comme dans sat(), sans les voies au-dela de nb */
+        rejets = (Uint32)_mm_movemask_ps(_mm_castsi128_ps(separe)) & ((lot->nb - j >= 4) ? 0xF : (1u << (lot->nb - j)) - 1);
+        for (; rejets != 0; rejets &= rejets - 1)
+        {
+            nb_rejets += 1;
+        }
+        if (_mm_movemask_epi8(separe) == 0xFFFF)
+        {
+            continue;
+        }
+        for (int k = 0; k < NB_POINTS_LOT; k++)
+        {
+            px[k] = _mm_loadu_si128((const __m128i *)(lot->points_x[k] + j));
+            py[k] = _mm_loadu_si128((const __m128i *)(lot->points_y[k] + j));
+        }
+
+        /* axes de la hitbox testee, precalcules une fois pour tout le lot */
+        for (int a = 0; a < axes->nb && _mm_movemask_epi8(separe) != 0xFFFF; a++)
+        {
+            ax = _mm_set1_epi32(axes->x[a]);
+            ay = _mm_set1_epi32(axes->y[a]);
+            min2 = _mm_add_epi32(mulloSSE2(ax, px[0]), mulloSSE2(ay, py[0]));
+            max2 = min2;
+            for (int k = 1; k < NB_POINTS_LOT; k++)
+            {
+                p = _mm_add_epi32(mulloSSE2(ax, px[k]), mulloSSE2(ay, py[k]));
+                min2 = minSSE2(min2, p);
+                max2 = maxSSE2(max2, p);
+            }
+            separe = _mm_or_si128(separe, _mm_andnot_si128(_mm_cmpgt_epi32(max2, _mm_set1_epi32(axes->min[a])), tous));
+            separe = _mm_or_si128(separe, _mm_andnot_si128(_mm_cmpgt_epi32(_mm_set1_epi32(axes->max[a]), min2), tous));
+        }
+
+        /* axes des candidats */
+        for (int i = 0; i < NB_POINTS_LOT && _mm_movemask_epi8(separe) != 0xFFFF; i++)
+        {
+            int suivant = (i + 1) % NB_POINTS_LOT;
+            ax = _mm_sub_epi32(py[suivant], py[i]);
+            ay = _mm_sub_epi32(px[i], px[suivant]);
+            min2 = _mm_add_epi32(mulloSSE2(ax, px[0]), mulloSSE2(ay, py[0]));
+            max2 = min2;
+            for (int k = 1; k < NB_POINTS_LOT; k++)
+            {
+                p = _mm_add_epi32(mulloSSE2(ax, px[k]), mulloSSE2(ay, py[k]));
+                min2 = minSSE2(min2, p);
+                max2 = maxSSE2(max2, p);
+            }
+            min1 = _mm_add_epi32(mulloSSE2(ax, _mm_set1_epi32(axes->points_x[0])), mulloSSE2(ay, _mm_set1_epi32(axes->points_y[0])));
+            max1 = min1;
+            for (int k = 1; k < axes->nb; k++)
+            {
+                p = _mm_add_epi32(mulloSSE2(ax, _mm_set1_epi32(axes->points_x[k])), mulloSSE2(ay, _mm_set1_epi32(axes->points_y[k])));
+                min1 = minSSE2(min1, p);
+                max1 = maxSSE2(max1, p);
+            }
+            separe = _mm_or_si128(separe, _mm_andnot_si128(_mm_cmpgt_epi32(max2, min1), tous));
+            separe = _mm_or_si128(separe, _mm_andnot_si128(_mm_cmpgt_epi32(max1, min2), tous));
+        }
+        lot->masque[j >> 5] |= (Uint32)(~_mm_movemask_ps(_mm_castsi128_ps(separe)) & 0xF) << (j & 31);
+    }
+    compteurs_collision.nb_sat += lot->nb;
+    compteurs_collision.nb_rejets_cercle += nb_rejets;
+}
+
+CIBLE_AVX2 void collideLotAVX2(Hitbox *hitbox, LotHitbox *lot, AxesHitbox *axes)
+{
+    /* meme algorithme que collideLotSSE2, 8 candidats par iteration */
+    __m256i tous = _mm256_set1_epi32(-1);
+    __m256i qx = _mm256_set1_epi32(hitbox->x), qy = _mm256_set1_epi32(hitbox->y), qr = _mm256_set1_epi32(hitbox->forme->cercle_rayon);
+    __m256i px[NB_POINTS_LOT], py[NB_POINTS_LOT];
+    __m256i separe, dx, dy, rayons, ax, ay, p, min1, max1, min2, max2;
+    Uint64 nb_rejets = 0;
+    Uint32 rejets;
+    for (int j = 0; j < lot->nb; j += 8)
+    {
+        dx = _mm256_sub_epi32(qx, _mm256_loadu_si256((const __m256i *)(lot->cercle_x + j)));
+        dy = _mm256_sub_epi32(qy, _mm256_loadu_si256((const __m256i *)(lot->cercle_y + j)));
+        rayons = _mm256_add_epi32(qr, _mm256_loadu_si256((const __m256i *)(lot->cercle_rayon + j)));
+        separe = _mm256_cmpgt_epi32(_mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy)), _mm256_mullo_epi32(rayons, rayons));
+        rejets = (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(separe)) & ((lot->nb - j >= 8) ? 0xFF : (1u << (lot->nb - j)) - 1);
+        for (; rejets != 0; rejets &= rejets - 1)
+        {
+            nb_rejets += 1;
+        }
+        if (_mm256_movemask_epi8(separe) == -1)
+        {
+            continue;
+        }
+        for (int k = 0; k < NB_POINTS_LOT; k++)
+        {
+            px[k] = _mm256_loadu_si256((const __m256i *)(lot->points_x[k] + j));
+            py[k] = _mm256_loadu_si256((const __m256i *)(lot->points_y[k] + j));
+        }
+
+        for (int a = 0; a < axes->nb && _mm256_movemask_epi8(separe) != -1; a++)
+        {
+            ax = _mm256_set1_epi32(axes->x[a]);
+            ay = _mm256_set1_epi32(axes->y[a]);
+            min2 = _mm256_add_epi32(_mm256_mullo_epi32(ax, px[0]), _mm256_mullo_epi32(ay, py[0]));
+            max2 = min2;
+            for (int k = 1; k < NB_POINTS_LOT; k++)
+            {
+                p = _mm256_add_epi32(_mm256_mullo_epi32(ax, px[k]), _mm256_mullo_epi32(ay, py[k]));
+                min2 = _mm256_min_epi32(min2, p);
+                max2 = _mm256_max_epi32(max2, p);
+            }
+            separe = _mm256_or_si256(separe, _mm256_andnot_si256(_mm256_cmpgt_epi32(max2, _mm256_set1_epi32(axes->min[a])), tous));
+            separe = _mm256_or_si256(separe, _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(axes->max[a]), min2), tous));
+        }
+
+        for (int i = 0; i < NB_POINTS_LOT && _mm256_movemask_epi8(separe) != -1; i++)
+        {
+            int suivant = (i + 1) % NB_POINTS_LOT;
+            ax = _mm256_sub_epi32(py[suivant], py[i]);
+            ay = _mm256_sub_epi32(px[i], px[suivant]);
+            min2 = _mm256_add_epi32(_mm256_mullo_epi32(ax, px[0]), _mm256_mullo_epi32(ay, py[0]));
+            max2 = min2;
+            for (int k = 1; k < NB_POINTS_LOT; k++)
+            {
+                p = _mm256_add_epi32(_mm256_mullo_epi32(ax, px[k]), _mm256_mullo_epi32(ay, py[k]));
+                min2 = _mm256_min_epi32(min2, p);
+                max2 = _mm256_max_epi32(max2, p);
+            }
+            min1 = _mm256_add_epi32(_mm256_mullo_epi32(ax, _mm256_set1_epi32(axes->points_x[0])), _mm256_mullo_epi32(ay, _mm256_set1_epi32(axes->points_y[0])));
+            max1 = min1;
+            for (int k = 1; k < axes->nb; k++)
+            {
+                p = _mm256_add_epi32(_mm256_mullo_epi32(ax, _mm256_set1_epi32(axes->points_x[k])), _mm256_mullo_epi32(ay, _mm256_set1_epi32(axes->points_y[k])));
+                min1 = _mm256_min_epi32(min1, p);
+                max1 = _mm256_max_epi32(max1, p);
+            }
+            separe = _mm256_or_si256(separe, _mm256_andnot_si256(_mm256_cmpgt_epi32(max2, min1), tous));
+            separe = _mm256_or_si256(separe, _mm256_andnot_si256(_mm256_cmpgt_epi32(max1, min2), tous));
+        }
+        lot->masque[j >> 5] |= (Uint32)(~_mm256_movemask_ps(_mm256_castsi256_ps(separe)) & 0xFF) << (j & 31);
+    }
+    compteurs_collision.nb_sat += lot->nb;
+    compteurs_collision.nb_rejets_cercle += nb_rejets;
+}
+#endif
+
+void createLot(LotHitbox *lot, int capacite)
+{
+    /* capacite arrondie a 8 : les noyaux chargent toujours des blocs complets */
+    capacite = (capacite + 7) & ~7;
+    lot->nb = 0;
+    lot->nb_irreguliers = 0;
+    lot->capacite = capacite;
+    lot->cercle_x = SDL_calloc(capacite, sizeof(int));
+    lot->cercle_y = SDL_calloc(capacite, sizeof(int));
+    lot->cercle_rayon = SDL_calloc(capacite, sizeof(int));
+    for (int k = 0; k < NB_POINTS_LOT; k++)
+    {
+        lot->points_x[k] = SDL_calloc(capacite, sizeof(int));
+        lot->points_y[k] = SDL_calloc(capacite, sizeof(int));
+    }
+    lot->etiquettes = SDL_calloc(capacite, sizeof(int));
+    lot->irreguliers = SDL_calloc(capacite, sizeof(int));
+    lot->hitboxes = SDL_calloc(capacite, sizeof(Hitbox *));
+    lot->masque = SDL_calloc(capacite / 32 + 1, sizeof(Uint32));
+    lot->noyau = collideLotScalaire;
+    lot->nom_noyau = "scalaire";
+#ifdef COLLISIONS_X86
+    if (SDL_HasAVX2())
+    {
+        lot->noyau = collideLotAVX2;
+        lot->nom_noyau = "AVX2";
+    }
+    else if (SDL_HasSSE2())
+    {
+        lot->noyau = collideLotSSE2;
+        lot->nom_noyau = "SSE2";
+    }
+#endif
+}
+
+int collideLot(Hitbox *hitbox, LotHitbox *lot)
+{
+    /* teste hitbox contre tous les candidats du lot : bit j de lot->masque = sat(hitbox, candidat j) */
+    AxesHitbox axes;
+    int nb_hits = 0;
+    Uint32 bits;
+    for (int w = 0; w <= lot->nb / 32; w++)
+    {
+        lot->masque[w] = 0;
+    }
+    if (lot->nb == 0)
+    {
+        return 0;
+    }
+    axesHitbox(hitbox, &axes);
+    lot->noyau(hitbox, lot, &axes);
+    compteurs_collision.nb_paires_lot += lot->nb;
+    if (lot->nb & 31)
+    {
+        lot->masque[lot->nb >> 5] &= (1u << (lot->nb & 31)) - 1;
+    }
+    for (int i = 0; i < lot->nb_irreguliers; i++)
+    {
+        int j = lot->irreguliers[i];
+        if (sat(hitbox, lot->hitboxes[j]))
+        {
+            lot->masque[j >> 5] |= 1u << (j & 31);
+        }
+        else
+        {
+            lot->masque[j >> 5] &= ~(1u << (j & 31));
+        }
+    }
+    for (int w = 0; w <= lot->nb / 32; w++)
+    {
+        bits = lot->masque[w];
+        while (bits != 0)
+        {
+            bits &= bits - 1;
+            nb_hits += 1;
+        }
+    }
+    return nb_hits;
+}
+
+SDL_bool takeTache(Ordonnanceur *ordonnanceur, int id, Tache *tache)
+{
+    /* d'abord la file du thread (par le bas), sinon vol par le haut de celle des autres */
+    FileTaches *file;
+    int indice = -1;
+    for (int k = 0; k < ordonnanceur->nb_threads && indice < 0; k++)
+    {
+        file = &ordonnanceur->files[(id + k) % ordonnanceur->nb_threads];
+        SDL_AtomicLock(&file->verrou);
+        if (file->haut < file->bas)
+        {
+            if (k == 0)
+            {
+                file->bas -= 1;
+                indice = file->indices[file->bas];
+            }
+            else
+            {
+                indice = file->indices[file->haut];
+                file->haut += 1;
+                SDL_AtomicAdd(&ordonnanceur->nb_vols, 1);
+            }
+        }
+        SDL_AtomicUnlock(&file->verrou);
+    }
+    if (indice < 0)
+    {
+        return SDL_FALSE;
+    }
+    *tache = ordonnanceur->taches[indice];
+    return SDL_TRUE;
+}
+
+void runTache(Ordonnanceur *ordonnanceur, ContexteTravailleur *contexte, Tache *tache)
+{
+    tache->fonction(ordonnanceur->all, contexte, tache->debut, tache->fin);
+    if (contexte->id != 0)
+    {
+        contexte->nb_sat += compteurs_collision.nb_sat;
+        contexte->nb_rejets_cercle += compteurs_collision.nb_rejets_cercle;
+        contexte->nb_paires_lot += compteurs_collision.nb_paires_lot;
+        compteurs_collision.nb_sat = 0;
+        compteurs_collision.nb_rejets_cercle = 0;
+        compteurs_collision.nb_paires_lot = 0;
+    }
+    SDL_AtomicAdd(&ordonnanceur->restantes, -1);
+}
+
+int SDLCALL threadTravailleur(void *donnees)
+{
+    /* dort entre deux phases, puis vide sa file et vole les autres jusqu'a ce qu'il n'y ait plus rien */
+    ContexteTravailleur *contexte = donnees;
+    Ordonnanceur *ordonnanceur = contexte->ordonnanceur;
+    Tache tache;
+    while (1)
+    {
+        SDL_SemWait(ordonnanceur->reveil);
+        if (SDL_AtomicGet(&ordonnanceur->arret))
+        {
+            break;
+        }
+        while (takeTache(ordonnanceur, contexte->id, &tache))
+        {
+            runTache(ordonnanceur, contexte, &tache);
+        }
+    }
+    return 0;
+}
+
+void runTaches(Ordonnanceur *ordonnanceur, void (*fonction)(Everything *all, ContexteTravailleur *contexte, int debut, int fin), int nb, int taille)
+{
+    /* execute fonction sur [0, nb) decoupe en taches de taille elements et rend la main quand
+       toutes sont finies ; avec un seul thread ou une seule tache, appel direct */
+    FileTaches *file;
+    Tache tache;
+    int nb_taches, k;
+    if (nb <= 0)
+    {
+        return;
+    }
+    if (taille * CAPACITE_TACHES < nb)
+    {
+        taille = (nb + CAPACITE_TACHES - 1) / CAPACITE_TACHES;
+    }
+    nb_taches = (nb + taille - 1) / taille;
+    ordonnanceur->nb_phases += 1;
+    if (ordonnanceur->nb_threads <= 1 || nb_taches == 1)
+    {
+        fonction(ordonnanceur->all, &ordonnanceur->contextes[0], 0, nb);
+        return;
+    }
+    ordonnanceur->nb_phases_paralleles += 1;
+    ordonnanceur->nb_taches = nb_taches;
+    SDL_AtomicSet(&ordonnanceur->restantes, nb_taches);
+    for (k = 0; k < ordonnanceur->nb_threads; k++)
+    {
+        /* les files sont vides : la phase precedente est terminee */
+        file = &ordonnanceur->files[k];
+        SDL_AtomicLock(&file->verrou);
+        file->haut = 0;
+        file->bas = 0;
+        SDL_AtomicUnlock(&file->verrou);
+    }
+    for (int t = 0; t < nb_taches; t++)
+    {
+        ordonnanceur->taches[t].fonction = fonction;
+        ordonnanceur->taches[t].debut = t * taille;
+        ordonnanceur->taches[t].fin = SDL_min((t + 1) * taille, nb);
+        file = &ordonnanceur->files[t % ordonnanceur->nb_threads];
+        SDL_AtomicLock(&file->verrou);
+        file->indices[file->bas] = t;
+        file->bas += 1;
+        SDL_AtomicUnlock(&file->verrou);
+    }
+    for (k = 1; k < ordonnanceur->nb_threads; k++)
+    {
+        SDL_SemPost(ordonnanceur->reveil);
+    }
+    while (SDL_AtomicGet(&ordonnanceur->restantes) > 0)
+    {
+        if (takeTache(ordonnanceur, 0, &tache))
+        {
+            runTache(ordonnanceur, &ordonnanceur->contextes[0], &tache);
+        }
+    }
+    for (k = 1; k < ordonnanceur->nb_threads; k++)
+    {
+        compteurs_collision.nb_sat += ordonnanceur->contextes[k].nb_sat;
+        compteurs_collision.nb_rejets_cercle += ordonnanceur->contextes[k].nb_rejets_cercle;
+        compteurs_collision.nb_paires_lot += ordonnanceur->contextes[k].nb_paires_lot;
+        ordonnanceur->contextes[k].nb_sat = 0;
+        ordonnanceur->contextes[k].nb_rejets_cercle = 0;
+        ordonnanceur->contextes[k].nb_paires_lot = 0;
+    }
+}
+
+SDL_bool addTouche(ContexteTravailleur *contexte, int candidat)
+{
+    /* tampon prealloue par createOrdonnanceur ; ne grandit que si une phase depasse une touche par entite */
+    int *touches;
+    if (contexte->nb_touches >= contexte->capacite_touches)
+    {
+        touches = SDL_realloc(contexte->touches, 2 * (contexte->capacite_touches + 32) * sizeof(int));
+        if (touches == NULL)
+        {
+            fprintf(stderr, "Erreur dans addTouche : allocation impossible\n");
+            return SDL_FALSE;
+        }
+        contexte->touches = touches;
+        contexte->capacite_touches = 2 * (contexte->capacite_touches + 32);
+    }
+    contexte->touches[contexte->nb_touches] = candidat;
+    contexte->nb_touches += 1;
+    return SDL_TRUE;
+}
+
+void createOrdonnanceur(Everything *all, int nb_threads)
+{
+    /* a appeler apres les pools et la grille des tirs, dont les capacites dimensionnent les tampons ;
+       les travailleurs 1 a nb_threads - 1 sont crees ici, le thread principal est le travailleur 0 */
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    ContexteTravailleur *contexte;
+    ordonnanceur->all = all;
+    ordonnanceur->nb_threads = SDL_clamp(nb_threads, 1, NB_THREADS_MAX);
+    ordonnanceur->nb_taches = 0;
+    ordonnanceur->nb_phases = 0;
+    ordonnanceur->nb_phases_paralleles = 0;
+    ordonnanceur->capacite_entites = SDL_max(all->pool_mobs.capacite, all->pool_fireplayers.capacite);
+    ordonnanceur->capacite_candidats = SDL_max(all->grille_fireplayers.capacite_objets, NB_OBSTACLES_MAX);
+    ordonnanceur->mobs = SDL_malloc(ordonnanceur->capacite_entites * sizeof(Mob *));
+    ordonnanceur->tirs = SDL_malloc(ordonnanceur->capacite_entites * sizeof(FirePlayer *));
+    ordonnanceur->sortis = SDL_malloc(ordonnanceur->capacite_entites * sizeof(Uint8));
+    ordonnanceur->touches_debut = SDL_malloc(ordonnanceur->capacite_entites * sizeof(int));
+    ordonnanceur->touches_nb = SDL_malloc(ordonnanceur->capacite_entites * sizeof(int));
+    ordonnanceur->touches_contexte = SDL_malloc(ordonnanceur->capacite_entites * sizeof(int));
+    if (ordonnanceur->mobs == NULL || ordonnanceur->tirs == NULL || ordonnanceur->sortis == NULL
+        || ordonnanceur->touches_debut == NULL || ordonnanceur->touches_nb == NULL || ordonnanceur->touches_contexte == NULL)
+    {
+        fprintf(stderr, "Erreur dans createOrdonnanceur : allocation impossible\n");
+        ordonnanceur->capacite_entites = 0;
+    }
+    SDL_AtomicSet(&ordonnanceur->restantes, 0);
+    SDL_AtomicSet(&ordonnanceur->arret, 0);
+    SDL_AtomicSet(&ordonnanceur->nb_vols, 0);
+    ordonnanceur->reveil = SDL_CreateSemaphore(0);
+    if (ordonnanceur->reveil == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_CreateSemaphore : %s\n", SDL_GetError());
+        ordonnanceur->nb_threads = 1;
+    }
+    for (int id = 0; id < ordonnanceur->nb_threads; id++)
+    {
+        contexte = &ordonnanceur->contextes[id];
+        contexte->id = id;
+        contexte->ordonnanceur = ordonnanceur;
+        createLot(&contexte->lot, ordonnanceur->capacite_candidats);
+        contexte->candidats = SDL_malloc(ordonnanceur->capacite_candidats * sizeof(int));
+        /* une touche par entite suffit en jeu : addTouche n'a plus a allouer pendant les phases */
+        contexte->touches = SDL_malloc(ordonnanceur->capacite_entites * sizeof(int));
+        contexte->nb_touches = 0;
+        contexte->capacite_touches = (contexte->touches != NULL) ? ordonnanceur->capacite_entites : 0;
+        contexte->nb_sat = 0;
+        contexte->nb_rejets_cercle = 0;
+        contexte->nb_paires_lot = 0;
+        ordonnanceur->files[id].haut = 0;
+        ordonnanceur->files[id].bas = 0;
+        ordonnanceur->files[id].verrou = 0;
+        ordonnanceur->threads[id] = NULL;
+    }
+    for (int id = 1; id < ordonnanceur->nb_threads; id++)
+    {
+        ordonnanceur->threads[id] = SDL_CreateThread(threadTravailleur, "travailleur", &ordonnanceur->contextes[id]);
+        if (ordonnanceur->threads[id] == NULL)
+        {
+            /* on continue avec les travailleurs deja crees */
+            fprintf(stderr, "Erreur SDL_CreateThread : %s\n", SDL_GetError());
+            for (int j = id; j < ordonnanceur->nb_threads; j++)
+            {
+                destroyLot(&ordonnanceur->contextes[j].lot);
+                SDL_free(ordonnanceur->contextes[j].candidats);
+                SDL_free(ordonnanceur->contextes[j].touches);
+                ordonnanceur->contextes[j].candidats = NULL;
+                ordonnanceur->contextes[j].touches = NULL;
+            }
+            ordonnanceur->nb_threads = id;
+            break;
+        }
+    }
+}
+
+void destroyOrdonnanceur(Everything *all)
+{
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    if (ordonnanceur->nb_threads == 0)
+    {
+        return;
+    }
+    SDL_AtomicSet(&ordonnanceur->arret, 1);
+    for (int id = 1; id < ordonnanceur->nb_threads; id++)
+    {
+        SDL_SemPost(ordonnanceur->reveil);
+    }
+    for (int id = 1; id < ordonnanceur->nb_threads; id++)
+    {
+        SDL_WaitThread(ordonnanceur->threads[id], NULL);
+        ordonnanceur->threads[id] = NULL;
+    }
+    printf("Ordonnanceur : %d threads, %" SDL_PRIu64 " phases dont %" SDL_PRIu64 " en parallele, %d taches volees\n",
+           ordonnanceur->nb_threads, ordonnanceur->nb_phases, ordonnanceur->nb_phases_paralleles, SDL_AtomicGet(&ordonnanceur->nb_vols));
+    for (int id = 0; id < ordonnanceur->nb_threads; id++)
+    {
+        destroyLot(&ordonnanceur->contextes[id].lot);
+        SDL_free(ordonnanceur->contextes[id].candidats);
+        SDL_free(ordonnanceur->contextes[id].touches);
+        ordonnanceur->contextes[id].candidats = NULL;
+        ordonnanceur->contextes[id].touches = NULL;
+    }
+    SDL_free(ordonnanceur->mobs);
+    SDL_free(ordonnanceur->tirs);
+    SDL_free(ordonnanceur->sortis);
+    SDL_free(ordonnanceur->touches_debut);
+    SDL_free(ordonnanceur->touches_nb);
+    SDL_free(ordonnanceur->touches_contexte);
+    ordonnanceur->mobs = NULL;
+    ordonnanceur->tirs = NULL;
+    ordonnanceur->sortis = NULL;
+    ordonnanceur->touches_debut = NULL;
+    ordonnanceur->touches_nb = NULL;
+    ordonnanceur->touches_contexte = NULL;
+    if (ordonnanceur->reveil != NULL)
+    {
+        SDL_DestroySemaphore(ordonnanceur->reveil);
+        ordonnanceur->reveil = NULL;
+    }
+    ordonnanceur->capacite_entites = 0;
+    ordonnanceur->nb_threads = 0;
+}
+
+void integreProjectilesScalaire(Projectiles *projectiles, const int bornes[4], int cible_x, int cible_y, int distance2)
+{
+    /* un pas de chaque projectile ; retire s'il sort de bornes (x_min, y_min, x_max, y_max en pixels),
+       expire, ou touche le cercle de la cible (distance au carre < distance2) */
+    int px, py, dx, dy;
+    Uint32 bit;
+    for (int w = 0; w <= projectiles->nb / 32; w++)
+    {
+        projectiles->retires[w] = 0;
+        projectiles->touches[w] = 0;
+    }
+    for (int i = 0; i < projectiles->nb; i++)
+    {
+        projectiles->x[i] += projectiles->vx[i];
+        projectiles->y[i] += projectiles->vy[i];
+        projectiles->duree[i] -= 1;
+        px = projectiles->x[i] >> VIRGULE_PROJECTILE;
+        py = projectiles->y[i] >> VIRGULE_PROJECTILE;
+        dx = px - cible_x;
+        dy = py - cible_y;
+        bit = 1u << (i & 31);
+        if (dx * dx + dy * dy < distance2)
+        {
+            projectiles->touches[i >> 5] |= bit;
+            projectiles->retires[i >> 5] |= bit;
+        }
+        if (px < bornes[0] || py < bornes[1] || px > bornes[2] || py > bornes[3] || projectiles->duree[i] <= 0)
+        {
+            projectiles->retires[i >> 5] |= bit;
+        }
+    }
+}
+
+#ifdef COLLISIONS_X86
+CIBLE_SSE2 void integreProjectilesSSE2(Projectiles *projectiles, const int bornes[4], int cible_x, int cible_y, int distance2)
+{
+    /* 4 projectiles par iteration, memes calculs entiers que la version scalaire */
+    __m128i x, y, duree, px, py, dx, dy, touche, retire;
+    __m128i un = _mm_set1_epi32(1), cx = _mm_set1_epi32(cible_x), cy = _mm_set1_epi32(cible_y), d2 = _mm_set1_epi32(distance2);
+    __m128i x_min = _mm_set1_epi32(bornes[0]), y_min = _mm_set1_epi32(bornes[1]);
+    __m128i x_max = _mm_set1_epi32(bornes[2]), y_max = _mm_set1_epi32(bornes[3]);
+    for (int w = 0; w <= projectiles->nb / 32; w++)
+    {
+        projectiles->retires[w] = 0;
+        projectiles->touches[w] = 0;
+    }
+    for (int i = 0; i < projectiles->nb; i += 4)
+    {
+        x = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(projectiles->x + i)), _mm_loadu_si128((const __m128i *)(projectiles->vx + i)));
+        y = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(projectiles->y + i)), _mm_loadu_si128((const __m128i *)(projectiles->vy + i)));
+        duree = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(projectiles->duree + i)), un);
+        _mm_storeu_si128((__m128i *)(projectiles->x + i), x);
+        _mm_storeu_si128((__m128i *)(projectiles->y + i), y);
+        _mm_storeu_si128((__m128i *)(projectiles->duree + i), duree);
+        px = _mm_srai_epi32(x, VIRGULE_PROJECTILE);
+        py = _mm_srai_epi32(y, VIRGULE_PROJECTILE);
+        dx = _mm_sub_epi32(px, cx);
+        dy = _mm_sub_epi32(py, cy);
+        touche = _mm_cmplt_epi32(_mm_add_epi32(mulloSSE2(dx, dx), mulloSSE2(dy, dy)), d2);
+        retire = _mm_or_si128(_mm_cmplt_epi32(px, x_min), _mm_cmplt_epi32(py, y_min));
+        retire = _mm_or_si128(retire, _mm_or_si128(_mm_cmpgt_epi32(px, x_max), _mm_cmpgt_epi32(py, y_max)));
+        retire = _mm_or_si128(retire, _mm_or_si128(_mm_cmplt_epi32(duree, un), touche));
+        projectiles->touches[i >> 5] |= (Uint32)_mm_movemask_ps(_mm_castsi128_ps(touche)) << (i & 31);
+        projectiles->retires[i >> 5] |= (Uint32)_mm_movemask_ps(_mm_castsi128_ps(retire)) << (i & 31);
+    }
+}
+
+CIBLE_AVX2 void integreProjectilesAVX2(Projectiles *projectiles, const int bornes[4], int cible_x, int cible_y, int distance2)
+{
+    /* meme algorithme que integreProjectilesSSE2, 8 projectiles par iteration */
+    __m256i x, y, duree, px, py, dx, dy, touche, retire;
+    __m256i un = _mm256_set1_epi32(1), cx = _mm256_set1_epi32(cible_x), cy = _mm256_set1_epi32(cible_y), d2 = _mm256_set1_epi32(distance2);
+    __m256i x_min = _mm256_set1_epi32(bornes[0]), y_min = _mm256_set1_epi32(bornes[1]);
+    __m256i x_max = _mm256_set1_epi32(bornes[2]), y_max = _mm256_set1_epi32(bornes[3]);
+    for (int w = 0; w <= projectiles->nb / 32; w++)
+    {
+        projectiles->retires[w] = 0;
+        projectiles->touches[w] = 0;
+    }
+    for (int i = 0; i < projectiles->nb; i += 8)
+    {
+        x = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(projectiles->x + i)), _mm256_loadu_si256((const __m256i *)(projectiles->vx + i)));
+        y = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(projectiles->y + i)), _mm256_loadu_si256((const __m256i *)(projectiles->vy + i)));
+        duree = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(projectiles->duree + i)), un);
+        _mm256_storeu_si256((__m256i *)(projectiles->x + i), x);
+        _mm256_storeu_si256((__m256i *)(projectiles->y + i), y);
+        _mm256_storeu_si256((__m256i *)(projectiles->duree + i), duree);
+        px = _mm256_srai_epi32(x, VIRGULE_PROJECTILE);
+        py = _mm256_srai_epi32(y, VIRGULE_PROJECTILE);
+        dx = _mm256_sub_epi32(px, cx);
+        dy = _mm256_sub_epi32(py, cy);
+        /* AVX2 n'a que cmpgt : a < b s'ecrit b > a */
+        touche = _mm256_cmpgt_epi32(d2, _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy)));
+        retire = _mm256_or_si256(_mm256_cmpgt_epi32(x_min, px), _mm256_cmpgt_epi32(y_min, py));
+        retire = _mm256_or_si256(retire, _mm256_or_si256(_mm256_cmpgt_epi32(px, x_max), _mm256_cmpgt_epi32(py, y_max)));
+        retire = _mm256_or_si256(retire, _mm256_or_si256(_mm256_cmpgt_epi32(un, duree), touche));
+        projectiles->touches[i >> 5] |= (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(touche)) << (i & 31);
+        projectiles->retires[i >> 5] |= (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(retire)) << (i & 31);
+    }
+}
+#endif
+
+void reprendProjectiles(Projectiles *projectiles)
+{
+    /* colonnes retaillees d'un seul bloc dans l'arene apres resetArene : aucun projectile ne survit a
+       la partie, et les noyaux remettent a zero les mots de retires / touches qu'ils remplissent */
+    int capacite = projectiles->capacite, mots = capacite / 32 + 1;
+    Sint32 *colonnes;
+    projectiles->nb = 0;
+    if (projectiles->arene == NULL)
+    {
+        return;
+    }
+    colonnes = allocArene(projectiles->arene, 5 * capacite * sizeof(Sint32) + 2 * mots * sizeof(Uint32));
+    if (colonnes == NULL)
+    {
+        return;
+    }
+    projectiles->x = colonnes;
+    projectiles->y = colonnes + capacite;
+    projectiles->vx = colonnes + 2 * capacite;
+    projectiles->vy = colonnes + 3 * capacite;
+    projectiles->duree = colonnes + 4 * capacite;
+    projectiles->retires = (Uint32 *)(colonnes + 5 * capacite);
+    projectiles->touches = projectiles->retires + mots;
+}
+
+void createProjectiles(Projectiles *projectiles, int capacite, Arene *arene)
+{
+    /* capacite arrondie a 8 : les noyaux chargent toujours des blocs complets ; colonnes prises dans
+       arene au premier reprendProjectiles si elle est donnee */
+    double angle;
+    capacite = (capacite + 7) & ~7;
+    projectiles->nb = 0;
+    projectiles->nb_max = 0;
+    projectiles->nb_refus = 0;
+    projectiles->nb_tires = 0;
+    projectiles->capacite = capacite;
+    projectiles->arene = arene;
+    projectiles->x = NULL;
+    projectiles->y = NULL;
+    projectiles->vx = NULL;
+    projectiles->vy = NULL;
+    projectiles->duree = NULL;
+    projectiles->retires = NULL;
+    projectiles->touches = NULL;
+    if (arene == NULL)
+    {
+        projectiles->x = SDL_calloc(capacite, sizeof(Sint32));
+        projectiles->y = SDL_calloc(capacite, sizeof(Sint32));
+        projectiles->vx = SDL_calloc(capacite, sizeof(Sint32));
+        projectiles->vy = SDL_calloc(capacite, sizeof(Sint32));
+        projectiles->duree = SDL_calloc(capacite, sizeof(Sint32));
+        projectiles->retires = SDL_calloc(capacite / 32 + 1, sizeof(Uint32));
+        projectiles->touches = SDL_calloc(capacite / 32 + 1, sizeof(Uint32));
+    }
+    if (arene == NULL && (projectiles->x == NULL || projectiles->y == NULL || projectiles->vx == NULL || projectiles->vy == NULL
+        || projectiles->duree == NULL || projectiles->retires == NULL || projectiles->touches == NULL))
+    {
+        fprintf(stderr, "Erreur dans createProjectiles : allocation impossible\n");
+        projectiles->capacite = 0;
+    }
+    for (int d = 0; d < NB_DIRECTIONS; d++)
+    {
+        angle = 6.283185307179586 * d / NB_DIRECTIONS;
+        projectiles->direction_x[d] = (Sint32)SDL_floor(VITESSE_PROJECTILE * SDL_cos(angle) + 0.5);
+        projectiles->direction_y[d] = (Sint32)SDL_floor(VITESSE_PROJECTILE * SDL_sin(angle) + 0.5);
+    }
+    projectiles->texture = NULL;
+    projectiles->noyau = integreProjectilesScalaire;
+    projectiles->nom_noyau = "scalaire";
+#ifdef COLLISIONS_X86
+    if (SDL_HasAVX2())
+    {
+        projectiles->noyau = integreProjectilesAVX2;
+        projectiles->nom_noyau = "AVX2";
+    }
+    else if (SDL_HasSSE2())
+    {
+        projectiles->noyau = integreProjectilesSSE2;
+        projectiles->nom_noyau = "SSE2";
+    }
+#endif
+}
+
+void destroyProjectiles(Projectiles *projectiles)
+{
+    if (projectiles->arene == NULL)
+    {
+        SDL_free(projectiles->x);
+        SDL_free(projectiles->y);
+        SDL_free(projectiles->vx);
+        SDL_free(projectiles->vy);
+        SDL_free(projectiles->duree);
+        SDL_free(projectiles->retires);
+        SDL_free(projectiles->touches);
+    }
+    projectiles->x = NULL;
+    projectiles->y = NULL;
+    projectiles->vx = NULL;
+    projectiles->vy = NULL;
+    projectiles->duree = NULL;
+    projectiles->retires = NULL;
+    projectiles->touches = NULL;
+    projectiles->capacite = 0;
+    projectiles->nb = 0;
+}
+
+void addProjectile(Projectiles *projectiles, int x, int y, int direction)
+{
+    /* projectile tire de (x, y) en pixels ; tableaux pleins : tir refuse, comme allocPool */
+    int i = projectiles->nb;
+    if (i >= projectiles->capacite)
+    {
+        if (projectiles->nb_refus == 0)
+        {
+            fprintf(stderr, "Erreur dans addProjectile : %d projectiles, les tirs suivants sont refuses\n", projectiles->capacite);
+        }
+        projectiles->nb_refus += 1;
+        return;
+    }
+    direction &= NB_DIRECTIONS - 1;
+    projectiles->x[i] = x * (1 << VIRGULE_PROJECTILE);
+    projectiles->y[i] = y * (1 << VIRGULE_PROJECTILE);
+    projectiles->vx[i] = projectiles->direction_x[direction];
+    projectiles->vy[i] = projectiles->direction_y[direction];
+    projectiles->duree[i] = DUREE_PROJECTILE;
+    projectiles->nb += 1;
+    projectiles->nb_tires += 1;
+    if (projectiles->nb > projectiles->nb_max)
+    {
+        projectiles->nb_max = projectiles->nb;
+    }
+}
+
+int compacteProjectiles(Projectiles *projectiles)
+{
+    /* retire les projectiles marques en les remplacant par le dernier ; en parcourant du dernier
+       au premier, le remplacant a toujours deja ete examine. Renvoie le nombre de touches */
+    int nb_touches = 0, dernier;
+    Uint32 bits;
+    for (int w = projectiles->nb / 32; w >= 0; w--)
+    {
+        bits = projectiles->touches[w];
+        while (bits != 0)
+        {
+            bits &= bits - 1;
+            nb_touches += 1;
+        }
+        for (int j = 31; j >= 0 && projectiles->retires[w] != 0; j--)
+        {
+            if (projectiles->retires[w] & (1u << j))
+            {
+                projectiles->retires[w] &= ~(1u << j);
+                projectiles->nb -= 1;
+                dernier = projectiles->nb;
+                projectiles->x[w * 32 + j] = projectiles->x[dernier];
+                projectiles->y[w * 32 + j] = projectiles->y[dernier];
+                projectiles->vx[w * 32 + j] = projectiles->vx[dernier];
+                projectiles->vy[w * 32 + j] = projectiles->vy[dernier];
+                projectiles->duree[w * 32 + j] = projectiles->duree[dernier];
+            }
+        }
+    }
+    return nb_touches;
+}
+
+int stepProjectiles(Projectiles *projectiles, SDL_Rect *limites, Hitbox *cible)
+{
+    /* deplace tous les projectiles, retire ceux qui sortent de limites, expirent ou touchent le
+       cercle englobant de cible (NULL : aucune cible), et renvoie le nombre de touches */
+    int bornes[4] = {limites->x - RAYON_PROJECTILE, limites->y - RAYON_PROJECTILE,
+                     limites->x + limites->w + RAYON_PROJECTILE, limites->y + limites->h + RAYON_PROJECTILE};
+    int distance = (cible != NULL) ? RAYON_PROJECTILE + cible->forme->cercle_rayon : 0;
+    if (projectiles->nb == 0)
+    {
+        return 0;
+    }
+    projectiles->noyau(projectiles, bornes, cible != NULL ? cible->x : 0, cible != NULL ? cible->y : 0, distance * distance);
+    if (projectiles->nb & 31)
+    {
+        /* bits des voies calculees au-dela de nb par les noyaux */
+        projectiles->retires[projectiles->nb >> 5] &= (1u << (projectiles->nb & 31)) - 1;
+        projectiles->touches[projectiles->nb >> 5] &= (1u << (projectiles->nb & 31)) - 1;
+    }
+    return compacteProjectiles(projectiles);
+}
+
+void randomHitbox(Hitbox *hitbox, FormeHitbox *forme, int nb_points)
+{
+    /* polygone convexe aleatoire : points sur une ellipse, arrondis aux entiers */
+    int rx = rand() % 20 + 1, ry = rand() % 20 + 1;
+    double angle = (rand() % 628) / 100.0;
+    SDL_Point points[NB_POINTS_MAX_FORME];
+    for (int k = 0; k < nb_points; k++)
+    {
+        points[k].x = (int)(rx * SDL_cos(angle + k * 6.2832 / nb_points));
+        points[k].y = (int)(ry * SDL_sin(angle + k * 6.2832 / nb_points));
+    }
+    initFormeHitbox(forme, points, nb_points);
+    hitbox->forme = forme;
+    hitbox->x = rand() % 420 - 50;
+    hitbox->y = rand() % 340 - 50;
+}
+
+SDL_bool checkCollideLot(void)
+{
+    /* test differentiel : chaque noyau disponible doit donner exactement sat() */
+    void (*noyaux[3])(Hitbox *hitbox, LotHitbox *lot, AxesHitbox *axes) = {collideLotScalaire, NULL, NULL};
+    const char *noms[3] = {"scalaire", "SSE2", "AVX2"};
+    int nb_candidats = 1000, nb_requetes = 200, nb_erreurs = 0, nb_collisions = 0;
+    Uint64 sat_reference = 0, rejets_reference = 0;
+    Hitbox *candidats = SDL_malloc(nb_candidats * sizeof(Hitbox));
+    FormeHitbox *formes = SDL_malloc(nb_candidats * sizeof(FormeHitbox));
+    Hitbox requete;
+    FormeHitbox forme_requete;
+    LotHitbox lot;
+#ifdef COLLISIONS_X86
+    if (SDL_HasSSE2())
+    {
+        noyaux[1] = collideLotSSE2;
+    }
+    if (SDL_HasAVX2())
+    {
+        noyaux[2] = collideLotAVX2;
+    }
+#endif
+    srand(1234);
+    createLot(&lot, nb_candidats);
+    for (int j = 0; j < nb_candidats; j++)
+    {
+        randomHitbox(&candidats[j], &formes[j], (j % 10 == 0) ? 3 + rand() % 4 : 4);
+        addLot(&lot, &candidats[j], j);
+    }
+    for (int r = 0; r < nb_requetes; r++)
+    {
+        randomHitbox(&requete, &forme_requete, 3 + rand() % 4);
+        for (int n = 0; n < 3; n++)
+        {
+            if (noyaux[n] == NULL)
+            {
+                continue;
+            }
+            /* les compteurs de l'overlay ne doivent pas dependre du noyau choisi */
+            lot.noyau = noyaux[n];
+            compteurs_collision.nb_sat = 0;
+            compteurs_collision.nb_rejets_cercle = 0;
+            collideLot(&requete, &lot);
+            if (n == 0)
+            {
+                sat_reference = compteurs_collision.nb_sat;
+                rejets_reference = compteurs_collision.nb_rejets_cercle;
+            }
+            else if (compteurs_collision.nb_sat != sat_reference || compteurs_collision.nb_rejets_cercle != rejets_reference)
+            {
+                nb_erreurs += 1;
+            }
+            for (int j = 0; j < nb_candidats; j++)
+            {
+                if (hitLot(&lot, j) != sat(&requete, &candidats[j]))
+                {
+                    nb_erreurs += 1;
+                }
+                if (n == 0 && hitLot(&lot, j))
+                {
+                    nb_collisions += 1;
+                }
+            }
+        }
+    }
+    for (int n = 0; n < 3; n++)
+    {
+        printf("noyau %s : %s\n", noms[n], noyaux[n] == NULL ? "indisponible" : "teste");
+    }
+    printf("test differentiel collideLot/sat : %d erreurs sur %d paires (%d en collision)\n", nb_erreurs, nb_candidats * nb_requetes, nb_collisions);
+    SDL_free(candidats);
+    SDL_free(formes);
+    destroyLot(&lot);
+    return nb_erreurs == 0 ? SDL_TRUE : SDL_FALSE;
+}
+
+void randomProjectiles(Projectiles *projectiles, int nb)
+{
+    /* complete jusqu'a nb projectiles places et orientes au hasard, a duree de vie variable */
+    while (projectiles->nb < nb && projectiles->nb < projectiles->capacite)
+    {
+        addProjectile(projectiles, rand() % 320, rand() % 240, rand() % NB_DIRECTIONS);
+        projectiles->duree[projectiles->nb - 1] = 1 + rand() % DUREE_PROJECTILE;
+    }
+}
+
+SDL_bool checkProjectiles(void)
+{
+    /* test differentiel : chaque noyau disponible doit donner exactement la version scalaire */
+    void (*noyaux[3])(Projectiles *projectiles, const int bornes[4], int cible_x, int cible_y, int distance2) = {integreProjectilesScalaire, NULL, NULL};
+    int bornes[4] = {0, 0, 320, 240}, nb = 1001, nb_erreurs = 0;
+    Projectiles reference, projectiles;
+#ifdef COLLISIONS_X86
+    if (SDL_HasSSE2())
+    {
+        noyaux[1] = integreProjectilesSSE2;
+    }
+    if (SDL_HasAVX2())
+    {
+        noyaux[2] = integreProjectilesAVX2;
+    }
+#endif
+    srand(4321);
+    createProjectiles(&reference, nb, NULL);
+    createProjectiles(&projectiles, nb, NULL);
+    randomProjectiles(&reference, nb);
+    for (int n = 1; n < 3; n++)
+    {
+        if (noyaux[n] == NULL)
+        {
+            continue;
+        }
+        for (int pas = 0; pas < 100; pas++)
+        {
+            /* meme point de depart pour les deux noyaux, cible qui se deplace */
+            projectiles.nb = reference.nb;
+            SDL_memcpy(projectiles.x, reference.x, nb * sizeof(Sint32));
+            SDL_memcpy(projectiles.y, reference.y, nb * sizeof(Sint32));
+            SDL_memcpy(projectiles.vx, reference.vx, nb * sizeof(Sint32));
+            SDL_memcpy(projectiles.vy, reference.vy, nb * sizeof(Sint32));
+            SDL_memcpy(projectiles.duree, reference.duree, nb * sizeof(Sint32));
+            noyaux[n](&projectiles, bornes, 3 * pas, 2 * pas, 64);
+            integreProjectilesScalaire(&reference, bornes, 3 * pas, 2 * pas, 64);
+            for (int i = 0; i < nb; i++)
+            {
+                if (projectiles.x[i] != reference.x[i] || projectiles.y[i] != reference.y[i] || projectiles.duree[i] != reference.duree[i]
+                    || ((projectiles.retires[i >> 5] ^ reference.retires[i >> 5]) & (1u << (i & 31)))
+                    || ((projectiles.touches[i >> 5] ^ reference.touches[i >> 5]) & (1u << (i & 31))))
+                {
+                    nb_erreurs += 1;
+                }
+            }
+        }
+    }
+    printf("test differentiel des noyaux de projectiles : %d erreurs\n", nb_erreurs);
+    destroyProjectiles(&reference);
+    destroyProjectiles(&projectiles);
+    return nb_erreurs == 0 ? SDL_TRUE : SDL_FALSE;
+}
+
+SDL_bool checkPoignees(void)
+{
+    /* une poignee prise sur un mob ne doit plus le resoudre une fois le mob tue, libere, son bloc
+       realloue a un autre mob, ou le pool remis a zero */
+    Everything *all = SDL_calloc(1, sizeof(Everything));
+    Mob *mob, *autre;
+    Poignee poignee, nulle = {0, 0};
+    int nb_erreurs = 0;
+    if (all == NULL)
+    {
+        fprintf(stderr, "Erreur dans checkPoignees : allocation impossible\n");
+        return SDL_FALSE;
+    }
+    createPool(&all->pool_mobs, "Mob (test)", sizeof(Mob), 4, NULL);
+    mob = allocPool(&all->pool_mobs);
+    mob->mort = SDL_FALSE;
+    poignee = poigneeMob(mob, all);
+    nb_erreurs += resolveMob(poignee, all) != mob;
+    nb_erreurs += resolveMob(nulle, all) != NULL;
+    mob->mort = SDL_TRUE;
+    nb_erreurs += resolveMob(poignee, all) != NULL;
+    /* liberation puis reallocation du meme bloc par la free-list */
+    freePool(&all->pool_mobs, mob);
+    autre = allocPool(&all->pool_mobs);
+    autre->mort = SDL_FALSE;
+    nb_erreurs += autre != mob;
+    nb_erreurs += resolveMob(poignee, all) != NULL;
+    nb_erreurs += resolveMob(poigneeMob(autre, all), all) != autre;
+    /* remise a zero du pool puis reallocation par increment */
+    poignee = poigneeMob(autre, all);
+    resetPool(&all->pool_mobs);
+    mob = allocPool(&all->pool_mobs);
+    mob->mort = SDL_FALSE;
+    nb_erreurs += mob != autre;
+    nb_erreurs += resolveMob(poignee, all) != NULL;
+    /* indice hors des blocs deja sortis */
+    poignee.indice = 3;
+    nb_erreurs += resolveMob(poignee, all) != NULL;
+    printf("test des poignees perimees : %d erreurs\n", nb_erreurs);
+    destroyPool(&all->pool_mobs);
+    SDL_free(all);
+    return nb_erreurs == 0 ? SDL_TRUE : SDL_FALSE;
+}
+
+void benchProjectiles(void)
+{
+    /* un pas complet (integration, collision avec une cible, compactage) sur des effectifs
+       maintenus constants, avec le noyau scalaire puis celui choisi par createProjectiles */
+    int nb_projectiles[4] = {1000, 10000, 20000, 50000};
+    int nb_frames = 100, nb_touches, nb_retires;
+    Uint64 frequence = SDL_GetPerformanceFrequency(), debut, duree;
+    SDL_Rect limites = {0, 0, 320, 240};
+    FormeHitbox forme;
+    Hitbox cible = {&forme, 160, 180};
+    Projectiles projectiles;
+    initFormeRectangle(&forme, 7, 7);
+    printf("projectiles;noyau;ms_par_frame;retires_par_frame;touches_par_frame\n");
+    for (int n = 0; n < 4; n++)
+    {
+        for (int simd = 0; simd < 2; simd++)
+        {
+            srand(42);
+            createProjectiles(&projectiles, nb_projectiles[n], NULL);
+            if (!simd)
+            {
+                projectiles.noyau = integreProjectilesScalaire;
+                projectiles.nom_noyau = "scalaire";
+            }
+            else if (projectiles.noyau == integreProjectilesScalaire)
+            {
+                destroyProjectiles(&projectiles);
+                continue;
+            }
+            duree = 0;
+            nb_touches = 0;
+            nb_retires = 0;
+            for (int f = 0; f < nb_frames; f++)
+            {
+                randomProjectiles(&projectiles, nb_projectiles[n]);
+                debut = SDL_GetPerformanceCounter();
+                nb_touches += stepProjectiles(&projectiles, &limites, &cible);
+                duree += SDL_GetPerformanceCounter() - debut;
+                nb_retires += nb_projectiles[n] - projectiles.nb;
+            }
+            printf("%d;%s;%.3f;%.1f;%.1f\n", nb_projectiles[n], projectiles.nom_noyau, 1000.0 * duree / frequence / nb_frames,
+                   (double)nb_retires / nb_frames, (double)nb_touches / nb_frames);
+            destroyProjectiles(&projectiles);
+        }
+    }
+}
+
+int runTests(void)
+{
+    /* --test : les tests differentiels et celui des poignees, sans aucune mesure de temps ; tous
+       tournent meme si l'un echoue, et le statut de sortie dit s'ils passent tous */
+    SDL_bool reussi = checkCollideLot();
+    reussi = checkProjectiles() && reussi;
+    reussi = checkPoignees() && reussi;
+    printf("tests : %s\n", reussi ? "reussis" : "ECHEC");
+    return reussi ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void benchCollisions(void)
+{
+    /* compare les boucles imbriquees et la grille sur des mobs et des tirs places au hasard ;
+       l'exactitude des noyaux est verifiee par --test */
+    int nb_entites[4] = {10, 100, 1000, 10000};
+    int nb_frames = 10;
+    Uint64 frequence = SDL_GetPerformanceFrequency();
+    srand(42);
+    printf("entites;sat_par_frame_boucles;ms_par_frame_boucles;sat_par_frame_grille;ms_par_frame_grille;ms_par_frame_lot;collisions_boucles;collisions_grille;collisions_lot\n");
+    for (int n = 0; n < 4; n++)
+    {
+        int nb_mobs = nb_entites[n] / 2, nb_fires = nb_entites[n] - nb_mobs;
+        long nb_sat_boucles = 0, nb_sat_grille = 0, nb_hits_boucles = 0, nb_hits_grille = 0, nb_hits_lot = 0;
+        Uint64 debut, duree_boucles, duree_grille, duree_lot;
+        LotHitbox lot;
+        Hitbox *mobs = SDL_malloc(nb_mobs * sizeof(Hitbox));
+        Hitbox *fires = SDL_malloc(nb_fires * sizeof(Hitbox));
+        FormeHitbox forme_mob, forme_fire;
+        Grille grille;
+        createGrille(&grille, nb_fires, 4 * nb_fires);
+        createLot(&lot, nb_fires);
+        initFormeRectangle(&forme_mob, 6, 7);
+        initFormeRectangle(&forme_fire, 2, 3);
+        for (int i = 0; i < nb_mobs; i++)
+        {
+            mobs[i].forme = &forme_mob;
+            mobs[i].x = rand() % 320;
+            mobs[i].y = rand() % 240;
+        }
+        for (int i = 0; i < nb_fires; i++)
+        {
+            fires[i].forme = &forme_fire;
+            fires[i].x = rand() % 320;
+            fires[i].y = rand() % 240;
+        }
+
+        debut = SDL_GetPerformanceCounter();
+        for (int f = 0; f < nb_frames; f++)
+        {
+            for (int i = 0; i < nb_mobs; i++)
+            {
+                for (int j = 0; j < nb_fires; j++)
+                {
+                    nb_sat_boucles += 1;
+                    if (sat(&mobs[i], &fires[j]))
+                    {
+                        nb_hits_boucles += 1;
+                    }
+                }
+            }
+        }
+        duree_boucles = SDL_GetPerformanceCounter() - debut;
+
+        debut = SDL_GetPerformanceCounter();
+        for (int f = 0; f < nb_frames; f++)
+        {
+            clearGrille(&grille);
+            for (int j = 0; j < nb_fires; j++)
+            {
+                insertGrille(&grille, &fires[j], &fires[j]);
+            }
+            for (int i = 0; i < nb_mobs; i++)
+            {
+                int nb_candidats = queryGrille(&grille, &mobs[i]);
+                for (int c = 0; c < nb_candidats; c++)
+                {
+                    nb_sat_grille += 1;
+                    if (sat(&mobs[i], grille.objets[grille.candidats[c]]))
+                    {
+                        nb_hits_grille += 1;
+                    }
+                }
+            }
+        }
+        duree_grille = SDL_GetPerformanceCounter() - debut;
+
+        debut = SDL_GetPerformanceCounter();
+        for (int f = 0; f < nb_frames; f++)
+        {
+            clearGrille(&grille);
+            for (int j = 0; j < nb_fires; j++)
+            {
+                insertGrille(&grille, &fires[j], &fires[j]);
+            }
+            for (int i = 0; i < nb_mobs; i++)
+            {
+                int nb_candidats = queryGrille(&grille, &mobs[i]);
+                clearLot(&lot);
+                for (int c = 0; c < nb_candidats; c++)
+                {
+                    addLot(&lot, grille.objets[grille.candidats[c]], c);
+                }
+                nb_hits_lot += collideLot(&mobs[i], &lot);
+            }
+        }
+        duree_lot = SDL_GetPerformanceCounter() - debut;
+
+        printf("%d;%ld;%.3f;%ld;%.3f;%.3f;%ld;%ld;%ld\n", nb_entites[n],
+               nb_sat_boucles / nb_frames, 1000.0 * duree_boucles / frequence / nb_frames,
+               nb_sat_grille / nb_frames, 1000.0 * duree_grille / frequence / nb_frames,
+               1000.0 * duree_lot / frequence / nb_frames,
+               nb_hits_boucles / nb_frames, nb_hits_grille / nb_frames, nb_hits_lot / nb_frames);
+        destroyGrille(&grille);
+        destroyLot(&lot);
+        SDL_free(mobs);
+        SDL_free(fires);
+    }
+    benchProjectiles();
+}
+
+void createLotSprites(LotSprites *lot, int capacite)
+{
+    lot->capacite = capacite;
+    lot->nb = 0;
+    lot->nb_textures = 0;
+    lot->nb_draw_calls = 0;
+    lot->nb_draw_calls_frame = 0;
+    lot->nb_copies = 0;
+    lot->nb_copies_frame = 0;
+    lot->max_sprites = 0;
+    lot->nb_frames = 0;
+    lot->total_draw_calls = 0;
+    lot->total_sprites = 0;
+    lot->nb_sprites_frame = 0;
+    lot->cles = SDL_malloc(capacite * sizeof(Uint16));
+    lot->cles_triees = SDL_malloc(capacite * sizeof(Uint16));
+    lot->ordre = SDL_malloc(capacite * sizeof(int));
+    lot->ordre_trie = SDL_malloc(capacite * sizeof(int));
+    lot->src = SDL_malloc(capacite * sizeof(SDL_Rect));
+    lot->dst = SDL_malloc(capacite * sizeof(SDL_Rect));
+    lot->couleurs = SDL_malloc(capacite * sizeof(SDL_Color));
+    lot->sommets = SDL_malloc(4 * capacite * sizeof(SDL_Vertex));
+    lot->indices = SDL_malloc(6 * capacite * sizeof(int));
+    if (lot->cles == NULL || lot->cles_triees == NULL || lot->ordre == NULL || lot->ordre_trie == NULL
+        || lot->src == NULL || lot->dst == NULL || lot->couleurs == NULL || lot->sommets == NULL || lot->indices == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_malloc : impossible d'allouer le lot de %d sprites\n", capacite);
+        lot->capacite = 0;
+        return;
+    }
+    for (int i = 0; i < capacite; i++)
+    {
+        lot->indices[6 * i] = 4 * i;
+        lot->indices[6 * i + 1] = 4 * i + 1;
+        lot->indices[6 * i + 2] = 4 * i + 2;
+        lot->indices[6 * i + 3] = 4 * i + 2;
+        lot->indices[6 * i + 4] = 4 * i + 3;
+        lot->indices[6 * i + 5] = 4 * i;
+    }
+}
+
+void destroyLotSprites(LotSprites *lot)
+{
+    if (lot->nb_frames > 0)
+    {
+        printf("Lot de sprites : %.1f draw calls et %.1f sprites par frame en moyenne, %d sprites au maximum\n",
+               (double)lot->total_draw_calls / lot->nb_frames, (double)lot->total_sprites / lot->nb_frames, lot->max_sprites);
+    }
+    SDL_free(lot->cles);
+    SDL_free(lot->cles_triees);
+    SDL_free(lot->ordre);
+    SDL_free(lot->ordre_trie);
+    SDL_free(lot->src);
+    SDL_free(lot->dst);
+    SDL_free(lot->couleurs);
+    SDL_free(lot->sommets);
+    SDL_free(lot->indices);
+    lot->cles = NULL;
+    lot->cles_triees = NULL;
+    lot->ordre = NULL;
+    lot->ordre_trie = NULL;
+    lot->src = NULL;
+    lot->dst = NULL;
+    lot->couleurs = NULL;
+    lot->sommets = NULL;
+    lot->indices = NULL;
+    lot->capacite = 0;
+    lot->nb = 0;
+}
+
+void sortLotSprites(LotSprites *lot)
+{
+    /* tri par base 256 sur les cles de 16 bits : deux passes stables, l'ordre de soumission
+       est conserve entre sprites de meme couche et de meme texture */
+    int compte[256], *ordre, position;
+    Uint16 *cles;
+    for (int decalage = 0; decalage < 16; decalage += 8)
+    {
+        SDL_memset(compte, 0, sizeof(compte));
+        for (int i = 0; i < lot->nb; i++)
+        {
+            compte[(lot->cles[i] >> decalage) & 0xFF]++;
+        }
+        position = 0;
+        for (int c = 0; c < 256; c++)
+        {
+            int nb = compte[c];
+            compte[c] = position;
+            position += nb;
+        }
+        for (int i = 0; i < lot->nb; i++)
+        {
+            position = compte[(lot->cles[i] >> decalage) & 0xFF]++;
+            lot->cles_triees[position] = lot->cles[i];
+            lot->ordre_trie[position] = lot->ordre[i];
+        }
+        cles = lot->cles;
+        lot->cles = lot->cles_triees;
+        lot->cles_triees = cles;
+        ordre = lot->ordre;
+        lot->ordre = lot->ordre_trie;
+        lot->ordre_trie = ordre;
+    }
+}
+
+void drawLotSprites(Everything *all)
+{
+    /* trie les sprites collectes, remplit les sommets dans l'ordre trie et dessine chaque suite
+       de meme texture en un seul SDL_RenderGeometry : des couches consecutives qui partagent
+       une texture (l'atlas) ne coutent qu'un appel */
+    LotSprites *lot = &all->sprites;
+    SDL_Vertex *sommet;
+    SDL_Rect *src, *dst;
+    SDL_Color couleur;
+    int debut, fin, texture;
+    float u1, v1, u2, v2;
+    if (lot->nb == 0)
+    {
+        return;
+    }
+    DEBUT_TRACE(&all->trace, "drawLotSprites");
+    sortLotSprites(lot);
+    for (int i = 0; i < lot->nb; i++)
+    {
+        src = &lot->src[lot->ordre[i]];
+        dst = &lot->dst[lot->ordre[i]];
+        texture = lot->cles[i] & 0xFF;
+        u1 = src->x / lot->largeurs[texture];
+        v1 = src->y / lot->hauteurs[texture];
+        u2 = (src->x + src->w) / lot->largeurs[texture];
+        v2 = (src->y + src->h) / lot->hauteurs[texture];
+        couleur = lot->couleurs[lot->ordre[i]];
+        sommet = &lot->sommets[4 * i];
+        sommet[0].color = couleur;
+        sommet[1].color = couleur;
+        sommet[2].color = couleur;
+        sommet[3].color = couleur;
+        sommet[0].position.x = dst->x;
+        sommet[0].position.y = dst->y;
+        sommet[0].tex_coord.x = u1;
+        sommet[0].tex_coord.y = v1;
+        sommet[1].position.x = dst->x + dst->w;
+        sommet[1].position.y = dst->y;
+        sommet[1].tex_coord.x = u2;
+        sommet[1].tex_coord.y = v1;
+        sommet[2].position.x = dst->x + dst->w;
+        sommet[2].position.y = dst->y + dst->h;
+        sommet[2].tex_coord.x = u2;
+        sommet[2].tex_coord.y = v2;
+        sommet[3].position.x = dst->x;
+        sommet[3].position.y = dst->y + dst->h;
+        sommet[3].tex_coord.x = u1;
+        sommet[3].tex_coord.y = v2;
+    }
+    for (debut = 0; debut < lot->nb; debut = fin)
+    {
+        fin = debut + 1;
+        while (fin < lot->nb && (lot->cles[fin] & 0xFF) == (lot->cles[debut] & 0xFF))
+        {
+            fin++;
+        }
+        SDL_RenderGeometry(all->renderer, lot->textures[lot->cles[debut] & 0xFF], &lot->sommets[4 * debut],
+                           4 * (fin - debut), lot->indices, 6 * (fin - debut));
+        lot->nb_draw_calls++;
+    }
+    lot->nb_sprites_frame += lot->nb;
+    lot->nb = 0;
+    lot->nb_textures = 0;
+    FIN_TRACE(&all->trace);
+}
+
+void addSpriteCouleur(SDL_Texture *texture, SDL_Rect *src_rect, SDL_Rect *dst_rect, int couche, SDL_Color couleur, Everything *all)
+{
+    /* la couleur module la texture, comme SDL_SetTextureColorMod mais par sprite */
+    LotSprites *lot = &all->sprites;
+    int indice, largeur = 0, hauteur = 0;
+    if (texture == NULL)
+    {
+        return;
+    }
+    if (lot->capacite == 0)
+    {
+        SDL_SetTextureColorMod(texture, couleur.r, couleur.g, couleur.b);
+        SDL_RenderCopy(all->renderer, texture, src_rect, dst_rect);
+        SDL_SetTextureColorMod(texture, 255, 255, 255);
+        lot->nb_copies++;
+        return;
+    }
+    for (indice = 0; indice < lot->nb_textures && lot->textures[indice] != texture; indice++)
+    {
+    }
+    if (lot->nb == lot->capacite || indice == NB_TEXTURES_LOT_SPRITES)
+    {
+        /* lot plein : on dessine ce qui a ete collecte et on repart d'un lot vide */
+        drawLotSprites(all);
+        indice = 0;
+    }
+    if (indice == lot->nb_textures)
+    {
+        SDL_QueryTexture(texture, NULL, NULL, &largeur, &hauteur);
+        lot->textures[indice] = texture;
+        lot->largeurs[indice] = (largeur > 0) ? largeur : 1;
+        lot->hauteurs[indice] = (hauteur > 0) ? hauteur : 1;
+        lot->nb_textures++;
+    }
+    lot->cles[lot->nb] = (Uint16)(couche << 8 | indice);
+    lot->ordre[lot->nb] = lot->nb;
+    lot->src[lot->nb] = *src_rect;
+    lot->dst[lot->nb] = *dst_rect;
+    lot->couleurs[lot->nb] = couleur;
+    lot->nb++;
+}
+
+void addSprite(SDL_Texture *texture, SDL_Rect *src_rect, SDL_Rect *dst_rect, int couche, Everything *all)
+{
+    SDL_Color blanc = {255, 255, 255, 255};
+    addSpriteCouleur(texture, src_rect, dst_rect, couche, blanc, all);
+}
+
+void countLotSprites(LotSprites *lot)
+{
+    /* fin de frame : les compteurs de la frame passent dans les totaux */
+    lot->nb_draw_calls_frame = lot->nb_draw_calls;
+    lot->nb_copies_frame = lot->nb_copies;
+    lot->total_draw_calls += lot->nb_draw_calls;
+    lot->total_sprites += lot->nb_sprites_frame;
+    if ((int)lot->nb_sprites_frame > lot->max_sprites)
+    {
+        lot->max_sprites = (int)lot->nb_sprites_frame;
+    }
+    lot->nb_frames++;
+    lot->nb_draw_calls = 0;
+    lot->nb_copies = 0;
+    lot->nb_sprites_frame = 0;
+}
+
+void destroyText(Text *text, Everything *all)
+{
+    Text *text_liste = &all->liste_text, *tmp = NULL;
+    if (text == NULL)
+    {
+        fprintf(stderr, "Erreur dans destroyText : le Text passé en paramètre est un pointeur NULL");
+        return;
+    }
+    while (text_liste->suivant != text)
+    {
+        text_liste = text_liste->suivant;
+    }
+    if (text_liste->suivant->texture != NULL)
+    {
+        SDL_DestroyTexture(text_liste->suivant->texture);
+    }
+    tmp = text_liste->suivant->suivant;
+    freePool(&all->pool_texts, text_liste->suivant);
+    text_liste->suivant = tmp;
+}
+
+SDL_Surface *renderPoliceAtlas(PoliceAtlas *police, TTF_Font *font)
+{
+    /* rasterise en blanc chaque glyphe imprimable et les range par lignes dans une surface, en
+       gardant avance et kerning ; sans renderer, peut tourner sur le thread de chargement */
+    SDL_Surface *glyphes[NB_GLYPHES] = {NULL}, *atlas = NULL, *surface;
+    SDL_Color blanc = {255, 255, 255, 255};
+    char caractere[2] = {0, 0};
+    int x = 0, y = 0, hauteur_ligne = 0, i, j;
+    if (font == NULL)
+    {
+        return NULL;
+    }
+    police->hauteur = TTF_FontHeight(font);
+    for (i = 0; i < NB_GLYPHES; i++)
+    {
+        caractere[0] = (char)(PREMIER_GLYPHE + i);
+        TTF_GlyphMetrics(font, PREMIER_GLYPHE + i, NULL, NULL, NULL, NULL, &police->glyphes[i].avance);
+        for (j = 0; j < NB_GLYPHES; j++)
+        {
+            police->crenage[i][j] = (Sint8)TTF_GetFontKerningSizeGlyphs(font, PREMIER_GLYPHE + i, PREMIER_GLYPHE + j);
+        }
+        surface = TTF_RenderText_Solid(font, caractere, blanc);
+        if (surface == NULL)
+        {
+            police->glyphes[i].rect.w = 0;
+            police->glyphes[i].rect.h = 0;
+            continue;
+        }
+        glyphes[i] = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(surface);
+        if (glyphes[i] == NULL)
+        {
+            continue;
+        }
+        if (x + glyphes[i]->w > LARGEUR_ATLAS_GLYPHES)
+        {
+            y += hauteur_ligne + 1;
+            x = 0;
+            hauteur_ligne = 0;
+        }
+        police->glyphes[i].rect.x = x;
+        police->glyphes[i].rect.y = y;
+        police->glyphes[i].rect.w = glyphes[i]->w;
+        police->glyphes[i].rect.h = glyphes[i]->h;
+        x += glyphes[i]->w + 1;
+        if (glyphes[i]->h > hauteur_ligne)
+        {
+            hauteur_ligne = glyphes[i]->h;
+        }
+    }
+    atlas = SDL_CreateRGBSurfaceWithFormat(0, LARGEUR_ATLAS_GLYPHES, y + hauteur_ligne, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_CreateRGBSurfaceWithFormat : %s\n", SDL_GetError());
+    }
+    else
+    {
+        SDL_FillRect(atlas, NULL, 0);
+        for (i = 0; i < NB_GLYPHES; i++)
+        {
+            if (glyphes[i] != NULL)
+            {
+                SDL_SetSurfaceBlendMode(glyphes[i], SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(glyphes[i], NULL, atlas, &police->glyphes[i].rect);
+            }
+        }
+    }
+    for (i = 0; i < NB_GLYPHES; i++)
+    {
+        if (glyphes[i] != NULL)
+        {
+            SDL_FreeSurface(glyphes[i]);
+        }
+    }
+    return atlas;
+}
+
+void uploadPoliceAtlas(PoliceAtlas *police, SDL_Surface *atlas, Everything *all)
+{
+    /* la surface reste a l'appelant */
+    police->texture = SDL_CreateTextureFromSurface(all->renderer, atlas);
+    if (police->texture == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_CreateTextureFromSurface : %s\n", SDL_GetError());
+        return;
+    }
+    SDL_SetTextureBlendMode(police->texture, SDL_BLENDMODE_BLEND);
+}
+
+void loadPoliceAtlas(PoliceAtlas *police, TTF_Font *font, Everything *all)
+{
+    /* une fois l'atlas en texture, afficher une chaine ne fait plus aucun appel a la TTF */
+    SDL_Surface *atlas;
+    police->texture = NULL;
+    if (font == NULL || all->renderer == NULL)
+    {
+        return;
+    }
+    DEBUT_TRACE(&all->trace, "loadPoliceAtlas");
+    atlas = renderPoliceAtlas(police, font);
+    if (atlas != NULL)
+    {
+        uploadPoliceAtlas(police, atlas, all);
+        SDL_FreeSurface(atlas);
+    }
+    FIN_TRACE(&all->trace);
+}
+
+void destroyPoliceAtlas(PoliceAtlas *police)
+{
+    if (police->texture != NULL)
+    {
+        SDL_DestroyTexture(police->texture);
+        police->texture = NULL;
+    }
+}
+
+int drawString(PoliceAtlas *police, const char texte[], int x, int y, SDL_Color couleur, Everything *all)
+{
+    /* un quad par caractere dans le lot de sprites, sans allocation ; renvoie l'abscisse de fin */
+    SDL_Rect dst_rect;
+    int glyphe, precedent = -1;
+    if (police->texture == NULL)
+    {
+        return x;
+    }
+    for (const char *c = texte; *c != '\0'; c++)
+    {
+        glyphe = (unsigned char)*c - PREMIER_GLYPHE;
+        if (glyphe < 0 || glyphe >= NB_GLYPHES)
+        {
+            glyphe = '?' - PREMIER_GLYPHE;
+        }
+        if (precedent >= 0)
+        {
+            x += police->crenage[precedent][glyphe];
+        }
+        dst_rect.x = x;
+        dst_rect.y = y;
+        dst_rect.w = police->glyphes[glyphe].rect.w;
+        dst_rect.h = police->glyphes[glyphe].rect.h;
+        if (dst_rect.w > 0)
+        {
+            addSpriteCouleur(police->texture, &police->glyphes[glyphe].rect, &dst_rect, COUCHE_TEXTE, couleur, all);
+        }
+        x += police->glyphes[glyphe].avance;
+        precedent = glyphe;
+    }
+    return x;
+}
+
+void destroyFonts(Everything *all)
+{
+    Fonts *fonts = &all->fonts;
+    destroyPoliceAtlas(&fonts->atlas_titles);
+    destroyPoliceAtlas(&fonts->atlas_menu_button);
+    destroyPoliceAtlas(&fonts->atlas_secondary_titles);
+    if (fonts->titles != NULL)
+    {
+        TTF_CloseFont(fonts->titles);
+    }
+    if (fonts->menu_button != NULL)
+    {
+        TTF_CloseFont(fonts->menu_button);
+    }
+    if (fonts->secondary_titles != NULL)
+    {
+        TTF_CloseFont(fonts->secondary_titles);
+    }
+}
+
+void initCouleurs(Fonts *fonts)
+{
+    SDL_Color rouge = {200, 0, 0};
+    SDL_Color vert = {0, 200, 0};
+    SDL_Color vert_clair = {140, 200, 140};
+    fonts->rouge = rouge;
+    fonts->vert = vert;
+    fonts->vert_clair = vert_clair;
+}
+
+TTF_Font *openPolice(int police)
+{
+    /* sans Everything : appelee aussi par le thread de chargement */
+    const char *chemins[NB_POLICES] = {CHEMINS_POLICES};
+    int tailles[NB_POLICES] = {30, 18, 30};
+    TTF_Font *font = TTF_OpenFontRW(openAsset(chemins[police]), 1, tailles[police]);
+    if (font == NULL)
+    {
+        fprintf(stderr, "Erreur TTF_OpenFont : %s\n", TTF_GetError());
+    }
+    return font;
+}
+
+TTF_Font **slotPolice(Fonts *fonts, int police)
+{
+    switch (police)
+    {
+        case POLICE_TITLES :
+            return &fonts->titles;
+        case POLICE_MENU_BUTTON :
+            return &fonts->menu_button;
+        default :
+            return &fonts->secondary_titles;
+    }
+}
+
+PoliceAtlas *atlasPolice(Fonts *fonts, int police)
+{
+    switch (police)
+    {
+        case POLICE_TITLES :
+            return &fonts->atlas_titles;
+        case POLICE_MENU_BUTTON :
+            return &fonts->atlas_menu_button;
+        default :
+            return &fonts->atlas_secondary_titles;
+    }
+}
+
+void loadFonts(Everything *all)
+{
+    /* chargement synchrone, quand le thread de chargement n'a pas pu etre cree */
+    DEBUT_TRACE(&all->trace, "loadFonts");
+    initCouleurs(&all->fonts);
+    for (int i = 0; i < NB_POLICES; i++)
+    {
+        *slotPolice(&all->fonts, i) = openPolice(i);
+        loadPoliceAtlas(atlasPolice(&all->fonts, i), *slotPolice(&all->fonts, i), all);
+    }
+    FIN_TRACE(&all->trace);
+}
+
+void destroyPlayer(Everything *all)
+{
+    if (all->player.texture != NULL)
+    {
+        releaseTexture(all->player.texture, all);
+        all->player.texture = NULL;
+    }
+    if (all->projectiles.texture != NULL)
+    {
+        releaseTexture(all->projectiles.texture, all);
+        all->projectiles.texture = NULL;
+    }
+    all->projectiles.nb = 0;
+}
+
+void destroyFirePlayer(FirePlayer *fire, Everything *all)
+{
+    FirePlayer *fire_liste = &all->liste_fireplayer, *tmp = NULL;
+    if (fire == NULL)
+    {
+        fprintf(stderr, "Erreur dans destroyFirePlayer : le FirePlayer passé en paramètre est un pointeur NULL");
+        return;
+    }
+    while (fire_liste->suivant != fire)
+    {
+        fire_liste = fire_liste->suivant;
+    }
+    tmp = fire_liste->suivant->suivant;
+    freePool(&all->pool_fireplayers, fire_liste->suivant);
+    fire_liste->suivant = tmp;
+}
+
+void destroyMob(Mob *mob, Everything *all)
+{
+    Mob *mob_liste = &all->liste_mob, *tmp = NULL;
+    if (mob == NULL)
+    {
+        fprintf(stderr, "Erreur dans destroyMob : le Mob passé en paramètre est un pointeur NULL");
+        return;
+    }
+    while (mob_liste->suivant != mob)
+    {
+        mob_liste = mob_liste->suivant;
+    }
+    tmp = mob_liste->suivant->suivant;
+    if (mob_liste->suivant == all->dernier_mob)
+    {
+        all->dernier_mob = mob_liste;
+    }
+    freePool(&all->pool_mobs, mob_liste->suivant);
+    mob_liste->suivant = tmp;
+}
+
+void killFirePlayer(FirePlayer *fire, Everything *all)
+{
+    /* en cours de parcours : le tir reste chaine jusqu'a sweepFirePlayers */
+    if (!fire->mort)
+    {
+        fire->mort = SDL_TRUE;
+        all->nb_fireplayers_morts += 1;
+    }
+}
+
+void killMob(Mob *mob, Everything *all)
+{
+    if (!mob->mort)
+    {
+        mob->mort = SDL_TRUE;
+        all->nb_mobs_morts += 1;
+    }
+}
+
+void sweepFirePlayers(Everything *all)
+{
+    /* un seul parcours pour tous les tirs morts, qui retournent au pool ; l'ordre des vivants ne change pas */
+    FirePlayer *fire = &all->liste_fireplayer, *mort;
+    while (all->nb_fireplayers_morts > 0 && fire->suivant != NULL)
+    {
+        if (fire->suivant->mort)
+        {
+            mort = fire->suivant;
+            fire->suivant = mort->suivant;
+            freePool(&all->pool_fireplayers, mort);
+            all->nb_fireplayers_morts -= 1;
+        }
+        else
+        {
+            fire = fire->suivant;
+        }
+    }
+}
+
+void sweepMobs(Everything *all)
+{
+    Mob *mob = &all->liste_mob, *mort;
+    while (all->nb_mobs_morts > 0 && mob->suivant != NULL)
+    {
+        if (mob->suivant->mort)
+        {
+            mort = mob->suivant;
+            mob->suivant = mort->suivant;
+            if (mort == all->dernier_mob)
+            {
+                all->dernier_mob = mob;
+            }
+            freePool(&all->pool_mobs, mort);
+            all->nb_mobs_morts -= 1;
+        }
+        else
+        {
+            mob = mob->suivant;
+        }
+    }
+}
+
+void moveMob(int x, int y, Mob *mob)
+{
+    mob->hitbox.x += x;
+    mob->hitbox.y += y;
+}
+
+Mob *createMob(Everything *all)
+{
+    /* mob pret a l'emploi en (0, 0), pas encore chaine dans liste_mob */
+    Mob *mob = allocPool(&all->pool_mobs);
+    if (mob == NULL)
+    {
+        return NULL;
+    }
+    mob->src_rect = all->session.src_mob;
+    mob->texture = all->session.texture_mob;
+    mob->dst_rect.h = 16;
+    mob->dst_rect.w = 16;
+    mob->dst_rect.x = -8;
+    mob->dst_rect.y = -8;
+    mob->suivant = NULL;
+    mob->mort = SDL_FALSE;
+    mob->PV = 1;
+    mob->emetteur.tir = TIR_AUCUN;
+    mob->emetteur.periode = 0;
+    mob->emetteur.minuterie = 0;
+    mob->emetteur.direction = 0;
+    mob->hitbox.forme = &all->formes.mob;
+    mob->hitbox.x = 0;
+    mob->hitbox.y = 0;
+    return mob;
+}
+
+char *loadTexte(const char chemin[])
+{
+    /* contenu d'un fichier de donnees termine par '\0', a liberer avec SDL_free ; NULL s'il manque */
+    SDL_RWops *fichier = openAsset(chemin);
+    char *texte = NULL;
+    Sint64 taille;
+    if (fichier == NULL)
+    {
+        return NULL;
+    }
+    taille = SDL_RWsize(fichier);
+    texte = (taille >= 0) ? SDL_malloc(taille + 1) : NULL;
+    if (texte != NULL && SDL_RWread(fichier, texte, 1, taille) == (size_t)taille)
+    {
+        texte[taille] = '\0';
+    }
+    else
+    {
+        SDL_free(texte);
+        texte = NULL;
+    }
+    SDL_RWclose(fichier);
+    return texte;
+}
+
+Uint32 hashDonnees(void)
+{
+    /* FNV-1a sur le contenu de la timeline des vagues puis du niveau, tels que les lira Init
+       (archive comprise) ; un fichier manquant compte comme un octet 0xFF */
+    const char *chemins[] = {CHEMIN_VAGUES, CHEMIN_NIVEAU};
+    Uint32 hash = 2166136261u;
+    char *texte;
+    for (int i = 0; i < 2; i++)
+    {
+        texte = loadTexte(chemins[i]);
+        if (texte == NULL)
+        {
+            hash = (hash ^ 0xFF) * 16777619u;
+            continue;
+        }
+        for (char *c = texte; *c != '\0'; c++)
+        {
+            hash = (hash ^ (Uint8)*c) * 16777619u;
+        }
+        hash *= 16777619u;      /* un octet 0 separe les deux fichiers */
+        SDL_free(texte);
+    }
+    return hash;
+}
+
+int decoupeLigne(char ligne[], char *mots[], int nb_max)
+{
+    /* coupe ligne en place en mots separes par des blancs ; un '#' commence un commentaire */
+    int nb = 0;
+    char *c = ligne;
+    while (nb < nb_max)
+    {
+        while (*c == ' ' || *c == '\t' || *c == '\r')
+        {
+            c++;
+        }
+        if (*c == '\0' || *c == '#')
+        {
+            break;
+        }
+        mots[nb++] = c;
+        while (*c != '\0' && *c != ' ' && *c != '\t' && *c != '\r')
+        {
+            c++;
+        }
+        if (*c == '\0')
+        {
+            break;
+        }
+        *c++ = '\0';
+    }
+    return nb;
+}
+
+void loadVagues(Everything *all)
+{
+    /* lit la timeline dans le modele et la trie par tick (a tick egal, dans l'ordre du fichier) ;
+       sans fichier, la vague d'origine : trois mobs en haut de l'ecran, sans tir */
+    Vagues *vagues = &all->vagues;
+    const char *motifs[NB_MOTIFS] = {"ligne", "colonne", "v", "cercle"};
+    const char *tirs[NB_TIRS] = {"aucun", "radial", "vise", "spirale"};
+    Vague defaut[] = {
+        {0, 160, 20, 1, MOTIF_LIGNE, 1, 0, TIR_AUCUN, 0, NULL, NULL, 0},
+        {0, 80, 20, 1, MOTIF_LIGNE, 1, 0, TIR_AUCUN, 0, NULL, NULL, 0},
+        {0, 240, 20, 1, MOTIF_LIGNE, 1, 0, TIR_AUCUN, 0, NULL, NULL, 0}
+    };
+    char *texte = loadTexte(CHEMIN_VAGUES), *ligne, *fin, *fin_nombre, *mots[10];
+    int numero = 0, i, j, motif, tir, periode, valeurs[6];
+    Vague tmp;
+    vagues->nb = 0;
+    vagues->suivante = 0;
+    vagues->a_preparer = 0;
+    vagues->tick = 0;
+    vagues->nb_apparus = 0;
+    vagues->vagues = NULL;
+    vagues->modele = SDL_calloc(NB_VAGUES_MAX, sizeof(Vague));
+    if (vagues->modele == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_calloc : impossible d'allouer les vagues\n");
+        return;
+    }
+    if (texte == NULL)
+    {
+        SDL_memcpy(vagues->modele, defaut, sizeof(defaut));
+        vagues->nb = sizeof(defaut) / sizeof(defaut[0]);
+    }
+    for (ligne = texte; ligne != NULL && vagues->nb < NB_VAGUES_MAX; ligne = fin)
+    {
+        fin = SDL_strchr(ligne, '\n');
+        if (fin != NULL)
+        {
+            *fin++ = '\0';
+        }
+        numero++;
+        i = decoupeLigne(ligne, mots, 10);
+        if (i == 0)
+        {
+            continue;
+        }
+        tir = TIR_AUCUN;
+        periode = 0;
+        if (i == 9)
+        {
+            /* emetteur optionnel : motif de tir et periode en ticks */
+            for (tir = 0; tir < NB_TIRS && SDL_strcmp(mots[7], tirs[tir]) != 0; tir++)
+            {
+            }
+            periode = (int)SDL_strtol(mots[8], &fin_nombre, 10);
+            if (tir == NB_TIRS || *fin_nombre != '\0' || periode <= 0)
+            {
+                i = 0;
+            }
+            else
+            {
+                i = 7;
+            }
+        }
+        for (motif = 0; i == 7 && motif < NB_MOTIFS && SDL_strcmp(mots[4], motifs[motif]) != 0; motif++)
+        {
+        }
+        for (j = 0; i == 7 && motif < NB_MOTIFS && j < 6; j++)
+        {
+            valeurs[j] = (int)SDL_strtol(mots[j < 4 ? j : j + 1], &fin_nombre, 10);
+            if (*fin_nombre != '\0')
+            {
+                break;
+            }
+        }
+        if (i != 7 || motif == NB_MOTIFS || j < 6 || valeurs[0] < 0 || valeurs[3] <= 0)
+        {
+            fprintf(stderr, "Erreur loadVagues : ligne %d de %s ignoree (attendu : tick x y nombre ligne|colonne|v|cercle PV espacement [aucun|radial|vise|spirale periode])\n",
+                    numero, CHEMIN_VAGUES);
+            continue;
+        }
+        vagues->modele[vagues->nb].tick = (Uint32)valeurs[0];
+        vagues->modele[vagues->nb].x = valeurs[1];
+        vagues->modele[vagues->nb].y = valeurs[2];
+        vagues->modele[vagues->nb].nombre = valeurs[3];
+        vagues->modele[vagues->nb].motif = motif;
+        vagues->modele[vagues->nb].PV = valeurs[4];
+        vagues->modele[vagues->nb].espacement = valeurs[5];
+        vagues->modele[vagues->nb].tir = tir;
+        vagues->modele[vagues->nb].periode = periode;
+        vagues->modele[vagues->nb].prets = NULL;
+        vagues->modele[vagues->nb].dernier_pret = NULL;
+        vagues->modele[vagues->nb].nb_prets = 0;
+        vagues->nb++;
+    }
+    SDL_free(texte);
+    for (i = 1; i < vagues->nb; i++)
+    {
+        for (j = i; j > 0 && vagues->modele[j].tick < vagues->modele[j - 1].tick; j--)
+        {
+            tmp = vagues->modele[j];
+            vagues->modele[j] = vagues->modele[j - 1];
+            vagues->modele[j - 1] = tmp;
+        }
+    }
+}
+
+void placeVague(Vague *vague, int i, Mob *mob)
+{
+    /* position du i-eme mob de la vague autour de (x, y) selon le motif */
+    int decalage = i * vague->espacement - (vague->nombre - 1) * vague->espacement / 2;
+    double angle = 6.2832 * i / vague->nombre;
+    switch (vague->motif)
+    {
+        case MOTIF_COLONNE :        /* les suivants au-dessus, ils arrivent en file */
+            moveMob(vague->x, vague->y - i * vague->espacement, mob);
+            break;
+        case MOTIF_V :              /* pointe vers le bas, au centre */
+            moveMob(vague->x + decalage, vague->y - SDL_abs(decalage), mob);
+            break;
+        case MOTIF_CERCLE :
+            moveMob(vague->x + (int)SDL_floor(vague->espacement * SDL_cos(angle) + 0.5),
+                    vague->y + (int)SDL_floor(vague->espacement * SDL_sin(angle) + 0.5), mob);
+            break;
+        default :
+            moveMob(vague->x + decalage, vague->y, mob);
+            break;
+    }
+}
+
+void prepareVague(Vague *vague, Everything *all)
+{
+    /* alloue et place les mobs de la vague a l'avance : a son tick, il ne reste qu'a les chainer */
+    Mob *mob;
+    for (int i = 0; i < vague->nombre; i++)
+    {
+        mob = createMob(all);
+        if (mob == NULL)
+        {
+            break;
+        }
+        mob->PV = vague->PV;
+        mob->emetteur.tir = vague->tir;
+        mob->emetteur.periode = vague->periode;
+        mob->emetteur.minuterie = vague->periode;
+        placeVague(vague, i, mob);
+        if (vague->prets == NULL)
+        {
+            vague->prets = mob;
+        }
+        else
+        {
+            vague->dernier_pret->suivant = mob;
+        }
+        vague->dernier_pret = mob;
+        vague->nb_prets++;
+    }
+}
+
+void spawnVague(Vague *vague, Everything *all)
+{
+    /* O(1) : les mobs prets sont raccroches d'un coup derriere dernier_mob, sans parcourir liste_mob */
+    if (vague->prets == NULL)
+    {
+        return;
+    }
+    all->dernier_mob->suivant = vague->prets;
+    all->dernier_mob = vague->dernier_pret;
+    all->vagues.nb_apparus += vague->nb_prets;
+    vague->prets = NULL;
+    vague->dernier_pret = NULL;
+    vague->nb_prets = 0;
+}
+
+void updateVagues(Everything *all)
+{
+    /* un tick de la timeline : cout proportionnel aux vagues qui commencent, pas a sa longueur ;
+       une fois terminee, elle recommence des que l'ecran est vide */
+    Vagues *vagues = &all->vagues;
+    if (vagues->nb == 0)
+    {
+        return;
+    }
+    if (vagues->suivante == vagues->nb && all->liste_mob.suivant == NULL)
+    {
+        vagues->suivante = 0;
+        vagues->a_preparer = 0;
+        vagues->tick = 0;
+    }
+    while (vagues->a_preparer < vagues->nb && vagues->vagues[vagues->a_preparer].tick <= vagues->tick + AVANCE_VAGUE)
+    {
+        prepareVague(&vagues->vagues[vagues->a_preparer], all);
+        vagues->a_preparer++;
+    }
+    while (vagues->suivante < vagues->nb && vagues->vagues[vagues->suivante].tick <= vagues->tick)
+    {
+        spawnVague(&vagues->vagues[vagues->suivante], all);
+        vagues->suivante++;
+    }
+    vagues->tick++;
+}
+
+void resetVagues(Everything *all)
+{
+    /* rend au pool les mobs prepares mais pas encore apparus et remet la timeline au debut */
+    Vagues *vagues = &all->vagues;
+    Mob *mob, *suivant;
+    for (int i = 0; i < vagues->nb; i++)
+    {
+        for (mob = vagues->vagues[i].prets; mob != NULL; mob = suivant)
+        {
+            suivant = mob->suivant;
+            freePool(&all->pool_mobs, mob);
+        }
+        vagues->vagues[i].prets = NULL;
+        vagues->vagues[i].dernier_pret = NULL;
+        vagues->vagues[i].nb_prets = 0;
+    }
+    vagues->suivante = 0;
+    vagues->a_preparer = 0;
+    vagues->tick = 0;
+}
+
+void reprendVagues(Everything *all)
+{
+    /* la timeline de la partie est une copie du modele prise dans l'arene : en fin de partie, ses
+       mobs prepares disparaissent avec resetArene sans etre rendus au pool un par un */
+    Vagues *vagues = &all->vagues;
+    vagues->suivante = 0;
+    vagues->a_preparer = 0;
+    vagues->tick = 0;
+    if (vagues->modele == NULL)
+    {
+        return;
+    }
+    vagues->vagues = allocArene(&all->session.arene, vagues->nb * sizeof(Vague));
+    if (vagues->vagues != NULL)
+    {
+        SDL_memcpy(vagues->vagues, vagues->modele, vagues->nb * sizeof(Vague));
+    }
+}
+
+void destroyVagues(Everything *all)
+{
+    if (all->vagues.modele == NULL)
+    {
+        return;
+    }
+    printf("Vagues : %d dans la timeline, %" SDL_PRIu64 " mobs apparus\n", all->vagues.nb, all->vagues.nb_apparus);
+    resetVagues(all);
+    SDL_free(all->vagues.modele);
+    all->vagues.modele = NULL;
+    all->vagues.vagues = NULL;
+    all->vagues.nb = 0;
+}
+
+void destroyLevel(Everything *all)
+{
+    if (all->level.texture != NULL)
+    {
+        releaseTexture(all->level.texture, all);
+        all->level.texture = NULL;
+    }
+    if (all->level.hitboxes != NULL)
+    {
+        SDL_free(all->level.hitboxes);
+        SDL_free(all->level.formes);
+        all->level.nb_hitboxes = 0;
+    }
+}
+
+int listLabels(Everything *all, Label labels[])
+{
+    /* textes fixes de tous les ecrans, construits une fois et gardes jusqu'a Quit */
+    Level *level = &all->level;
+    Fonts *fonts = &all->fonts;
+    Label table[] = {
+        {&level->title, POLICE_TITLES, "Space Shooter", &fonts->vert, LABEL_CENTRE, 53},
+        {&level->start_game.text, POLICE_MENU_BUTTON, "Start Game", &fonts->vert_clair, LABEL_CENTRE, 130},
+        {&level->settings.text, POLICE_MENU_BUTTON, "Options", &fonts->vert_clair, LABEL_CENTRE, 160},
+        {&level->quit_game.text, POLICE_MENU_BUTTON, "Quit Game", &fonts->vert_clair, LABEL_CENTRE, 190},
+        {&level->game_over, POLICE_TITLES, "Game Over", &fonts->rouge, LABEL_CENTRE, 95},
+        {&level->settings_title, POLICE_SECONDARY_TITLES, "Options", &fonts->vert_clair, LABEL_CENTRE, 50},
+        {&level->control_settings.text, POLICE_MENU_BUTTON, "Keyboard Settings", &fonts->vert_clair, LABEL_CENTRE, 130},
+        {&level->back_to_menu.text, POLICE_MENU_BUTTON, "Back To Menu", &fonts->vert_clair, LABEL_CENTRE, 160},
+        {&level->control_settings_title, POLICE_SECONDARY_TITLES, "Keyboard Settings", &fonts->vert_clair, LABEL_CENTRE, 20},
+        {&level->chg_up.text, POLICE_MENU_BUTTON, "Up", &fonts->vert_clair, 40, 60},
+        {&level->chg_down.text, POLICE_MENU_BUTTON, "Down", &fonts->vert_clair, 40, 80},
+        {&level->chg_left.text, POLICE_MENU_BUTTON, "Left", &fonts->vert_clair, 40, 100},
+        {&level->chg_right.text, POLICE_MENU_BUTTON, "Right", &fonts->vert_clair, 40, 120},
+        {&level->chg_A.text, POLICE_MENU_BUTTON, "A", &fonts->vert_clair, 40, 140},
+        {&level->chg_B.text, POLICE_MENU_BUTTON, "B", &fonts->vert_clair, 200, 60},
+        {&level->chg_L.text, POLICE_MENU_BUTTON, "L", &fonts->vert_clair, 200, 80},
+        {&level->chg_R.text, POLICE_MENU_BUTTON, "R", &fonts->vert_clair, 200, 100},
+        {&level->chg_start.text, POLICE_MENU_BUTTON, "Start", &fonts->vert_clair, 200, 120},
+        {&level->chg_select.text, POLICE_MENU_BUTTON, "Select", &fonts->vert_clair, 200, 140},
+        {&level->control_back_to_settings.text, POLICE_MENU_BUTTON, "Save and Exit", &fonts->vert_clair, LABEL_CENTRE, 200}
+    };
+    SDL_memcpy(labels, table, sizeof(table));
+    return sizeof(table) / sizeof(table[0]);
+}
+
+void placeLabel(Label *label, Text *text)
+{
+    *label->text = text;
+    if (text != NULL)
+    {
+        text->dst_rect.x = (label->x == LABEL_CENTRE) ? 160 - (text->dst_rect.w / 2) : label->x;
+        text->dst_rect.y = label->y;
+    }
+}
+
+void loadLabels(Everything *all)
+{
+    /* chargement synchrone des textes, quand le thread de chargement n'a pas pu etre cree */
+    Label labels[NB_LABELS_MAX];
+    int nb_labels = listLabels(all, labels);
+    for (int i = 0; i < nb_labels; i++)
+    {
+        if (*labels[i].text == NULL)
+        {
+            placeLabel(&labels[i], loadText(*slotPolice(&all->fonts, labels[i].police), labels[i].chaine, *labels[i].couleur, all));
+        }
+    }
+}
+
+void changeScene(Everything *all, int game_state)
+{
+    /* les ressources de chaque ecran sont deja chargees : changer d'ecran ne fait que changer de pointeur */
+    all->game_state = game_state;
+    all->scene = &all->scenes[game_state];
+}
+
+void pushChargeur(Chargeur *chargeur, ElementCharge *element)
+{
+    /* cote thread de chargement : attend une place libre, ecrit l'element puis le publie */
+    int nb_pousses = SDL_AtomicGet(&chargeur->nb_pousses);
+    while (nb_pousses - SDL_AtomicGet(&chargeur->nb_retires) >= CAPACITE_FILE_CHARGEMENT)
+    {
+        SDL_Delay(1);
+    }
+    chargeur->file[nb_pousses % CAPACITE_FILE_CHARGEMENT] = *element;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&chargeur->nb_pousses, nb_pousses + 1);
+}
+
+SDL_bool popChargeur(Chargeur *chargeur, ElementCharge *element)
+{
+    /* cote thread principal, sans attente : SDL_FALSE si la file est vide */
+    int nb_retires = SDL_AtomicGet(&chargeur->nb_retires);
+    if (nb_retires == SDL_AtomicGet(&chargeur->nb_pousses))
+    {
+        return SDL_FALSE;
+    }
+    SDL_MemoryBarrierAcquire();
+    *element = chargeur->file[nb_retires % CAPACITE_FILE_CHARGEMENT];
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&chargeur->nb_retires, nb_retires + 1);
+    return SDL_TRUE;
+}
+
+int SDLCALL threadChargeur(void *donnees)
+{
+    /* seul code a utiliser la TTF pendant le chargement ; ne touche ni au renderer ni a Everything */
+    Chargeur *chargeur = donnees;
+    TTF_Font *polices[NB_POLICES];
+    ElementCharge element = {0};
+    for (int i = 0; i < NB_POLICES; i++)
+    {
+        polices[i] = openPolice(i);
+        element.type = ELEMENT_POLICE;
+        element.indice = i;
+        element.font = polices[i];
+        element.surface = NULL;
+        pushChargeur(chargeur, &element);
+    }
+    element.font = NULL;
+    for (int i = 0; i < NB_POLICES; i++)
+    {
+        element.type = ELEMENT_ATLAS_GLYPHES;
+        element.indice = i;
+        element.surface = (polices[i] != NULL) ? renderPoliceAtlas(chargeur->atlas[i], polices[i]) : NULL;
+        pushChargeur(chargeur, &element);
+    }
+    for (int i = 0; i < chargeur->nb_labels; i++)
+    {
+        Label *label = &chargeur->labels[i];
+        element.type = ELEMENT_TEXTE;
+        element.indice = i;
+        element.surface = NULL;
+        if (polices[label->police] != NULL)
+        {
+            element.surface = TTF_RenderText_Solid(polices[label->police], label->chaine, *label->couleur);
+            if (element.surface == NULL)
+            {
+                fprintf(stderr, "Erreur TTF_RenderText_Solid : %s\n", TTF_GetError());
+            }
+        }
+        pushChargeur(chargeur, &element);
+    }
+    for (int i = 0; i < chargeur->nb_images; i++)
+    {
+        element.type = ELEMENT_IMAGE;
+        element.indice = i;
+        element.chemin = chargeur->images[i];
+        element.surface = SDL_LoadBMP_RW(openAsset(chargeur->images[i]), 1);
+        if (element.surface == NULL)
+        {
+            fprintf(stderr, "Erreur SDL_LoadBMP : %s\n", SDL_GetError());
+        }
+        pushChargeur(chargeur, &element);
+    }
+    return 0;
+}
+
+SDL_bool startChargeur(Everything *all)
+{
+    /* lance le thread de chargement et affiche l'ecran de chargement ; SDL_FALSE si le thread
+       n'a pas pu etre cree, l'appelant chargeant alors tout de maniere synchrone */
+    Chargeur *chargeur = &all->chargeur;
+    const char *sprites[] = {CHEMINS_SPRITES};
+    initCouleurs(&all->fonts);
+    SDL_AtomicSet(&chargeur->nb_pousses, 0);
+    SDL_AtomicSet(&chargeur->nb_retires, 0);
+    chargeur->nb_labels = listLabels(all, chargeur->labels);
+    for (int i = 0; i < NB_POLICES; i++)
+    {
+        chargeur->atlas[i] = atlasPolice(&all->fonts, i);
+        chargeur->atlas[i]->texture = NULL;
+    }
+    chargeur->nb_images = 0;
+    if (all->atlas.nb > 0)
+    {
+        chargeur->images[chargeur->nb_images++] = CHEMIN_ATLAS_IMAGE;
+    }
+    else
+    {
+        for (int i = 0; i < (int)(sizeof(sprites) / sizeof(sprites[0])); i++)
+        {
+            chargeur->images[chargeur->nb_images++] = sprites[i];
+        }
+    }
+    chargeur->nb_total = 2 * NB_POLICES + chargeur->nb_labels + chargeur->nb_images;
+    chargeur->nb_termines = 0;
+    chargeur->thread = SDL_CreateThread(threadChargeur, "chargement", chargeur);
+    if (chargeur->thread == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_CreateThread : %s\n", SDL_GetError());
+        return SDL_FALSE;
+    }
+    changeScene(all, ETAT_CHARGEMENT);
+    return SDL_TRUE;
+}
+
+void finishElementCharge(ElementCharge *element, SDL_bool envoi, Everything *all)
+{
+    /* envoie au GPU la ressource d'un element retire de la file, ou la jette si envoi est faux */
+    Chargeur *chargeur = &all->chargeur;
+    SDL_Texture *texture;
+    switch (element->type)
+    {
+        case ELEMENT_POLICE :       /* gardee meme sans envoi, pour etre fermee par destroyFonts */
+            *slotPolice(&all->fonts, element->indice) = element->font;
+            break;
+        case ELEMENT_ATLAS_GLYPHES :
+            if (envoi && element->surface != NULL)
+            {
+                uploadPoliceAtlas(chargeur->atlas[element->indice], element->surface, all);
+            }
+            break;
+        case ELEMENT_TEXTE :
+            if (envoi && element->surface != NULL)
+            {
+                placeLabel(&chargeur->labels[element->indice], loadTextSurface(element->surface, all));
+            }
+            break;
+        case ELEMENT_IMAGE :
+            if (envoi && element->surface != NULL)
+            {
+                texture = loadSurface(element->surface, all->renderer);
+                if (texture != NULL)
+                {
+                    cacheTexture(element->chemin, texture, all);
+                }
+            }
+            break;
+    }
+    if (element->surface != NULL)
+    {
+        SDL_FreeSurface(element->surface);
+    }
+    chargeur->nb_termines++;
+}
+
+void updateChargeur(Everything *all)
+{
+    /* au plus UPLOADS_PAR_FRAME envois par frame pour garder l'ecran de chargement fluide */
+    Chargeur *chargeur = &all->chargeur;
+    ElementCharge element;
+    if (chargeur->thread == NULL)
+    {
+        return;
+    }
+    DEBUT_TRACE(&all->trace, "updateChargeur");
+    for (int i = 0; i < UPLOADS_PAR_FRAME && popChargeur(chargeur, &element); i++)
+    {
+        finishElementCharge(&element, SDL_TRUE, all);
+    }
+    if (chargeur->nb_termines == chargeur->nb_total)
+    {
+        SDL_WaitThread(chargeur->thread, NULL);
+        chargeur->thread = NULL;
+        changeScene(all, 0);
+    }
+    FIN_TRACE(&all->trace);
+}
+
+void destroyChargeur(Everything *all)
+{
+    /* fermeture pendant le chargement : vide la file jusqu'a la fin du thread sans rien envoyer */
+    Chargeur *chargeur = &all->chargeur;
+    ElementCharge element;
+    if (chargeur->thread == NULL)
+    {
+        return;
+    }
+    while (chargeur->nb_termines < chargeur->nb_total)
+    {
+        if (popChargeur(chargeur, &element))
+        {
+            finishElementCharge(&element, SDL_FALSE, all);
+        }
+        else
+        {
+            SDL_Delay(1);
+        }
+    }
+    SDL_WaitThread(chargeur->thread, NULL);
+    chargeur->thread = NULL;
+}
+
+void drawChargement(Everything *all)
+{
+    /* barre de progression dessinee sans aucune ressource, rien n'etant encore charge */
+    Chargeur *chargeur = &all->chargeur;
+    SDL_Rect cadre = {60, 114, 200, 12};
+    SDL_Rect barre = {62, 116, 0, 8};
+    barre.w = (chargeur->nb_total > 0) ? 196 * chargeur->nb_termines / chargeur->nb_total : 0;
+    SDL_SetRenderDrawColor(all->renderer, 140, 200, 140, 255);
+    SDL_RenderDrawRect(all->renderer, &cadre);
+    SDL_RenderFillRect(all->renderer, &barre);
+    SDL_SetRenderDrawColor(all->renderer, 0, 0, 0, 255);
+}
+
+SDL_bool reprendSession(Everything *all)
+{
+    /* tout ce qui vit le temps d'une partie, taille dans l'arene de session ; sur une arene a blanc,
+       ne fait que mesurer : toute allocation ajoutee ici compte aussi dans la taille de l'arene */
+    reprendPool(&all->pool_mobs);
+    reprendPool(&all->pool_fireplayers);
+    reprendProjectiles(&all->projectiles);
+    reprendVagues(all);
+    return all->session.arene.pleine ? SDL_FALSE : SDL_TRUE;
+}
+
+void createSession(Everything *all)
+{
+    /* l'arene est taillee en rejouant reprendSession a blanc, puis le decoupage est fait pour de bon */
+    Arene *arene = &all->session.arene;
+    mesureArene(arene, "Session");
+    reprendSession(all);
+    createArene(arene, "Session", arene->utilise);
+    if (arene->memoire == NULL || !reprendSession(all))
+    {
+        fprintf(stderr, "Erreur dans createSession : impossible de tailler la session dans l'arene\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void endSession(Everything *all)
+{
+    /* fin de partie : les mobs, tirs, projectiles et mobs prepares encore vivants ne sont pas rendus
+       un par un, l'arene repart de zero en O(1) et tout y est retaille dans l'ordre de main */
+    size_t octets = 0;
+    if (all->pool_mobs.arene == &all->session.arene)
+    {
+        octets += all->pool_mobs.nb_neufs * all->pool_mobs.taille_bloc;
+    }
+    if (all->pool_fireplayers.arene == &all->session.arene)
+    {
+        octets += all->pool_fireplayers.nb_neufs * all->pool_fireplayers.taille_bloc;
+    }
+    if (octets > all->session.max_octets)
+    {
+        all->session.max_octets = octets;
+    }
+    destroyPlayer(all);
+    if (all->session.texture_mob != NULL)
+    {
+        releaseTexture(all->session.texture_mob, all);
+        all->session.texture_mob = NULL;
+    }
+    if (all->session.texture_fireplayer != NULL)
+    {
+        releaseTexture(all->session.texture_fireplayer, all);
+        all->session.texture_fireplayer = NULL;
+    }
+    resetArene(&all->session.arene);
+    if (!reprendSession(all))
+    {
+        /* l'arene est taillee sur reprendSession : un refus ici est un bug, pas un manque de memoire */
+        fprintf(stderr, "Erreur dans endSession : l'arene de session deborde\n");
+        exit(EXIT_FAILURE);
+    }
+    all->liste_mob.suivant = NULL;
+    all->dernier_mob = &all->liste_mob;
+    all->liste_fireplayer.suivant = NULL;
+    all->nb_mobs_morts = 0;
+    all->nb_fireplayers_morts = 0;
+}
+
+void destroySession(Everything *all)
+{
+    if (all->session.arene.memoire == NULL)
+    {
+        return;
+    }
+    printf("Session : %d parties, %zu/%zu octets de l'arene utilises au maximum\n", all->session.nb_parties,
+           all->session.max_octets, all->session.arene.utilise);
+    destroyArene(&all->session.arene);
+}
+
+size_t octetsTexture(SDL_Texture *texture)
+{
+    Uint32 format;
+    int largeur, hauteur;
+    if (texture == NULL || SDL_QueryTexture(texture, &format, NULL, &largeur, &hauteur) != 0)
+    {
+        return 0;
+    }
+    return (size_t)largeur * hauteur * SDL_BYTESPERPIXEL(format);
+}
+
+size_t octetsTextures(Everything *all)
+{
+    /* cache (sprites et atlas), textes et atlas de glyphes : toutes les textures vivantes du programme */
+    size_t octets = octetsTexture(all->fonts.atlas_titles.texture) + octetsTexture(all->fonts.atlas_menu_button.texture)
+                    + octetsTexture(all->fonts.atlas_secondary_titles.texture);
+    for (CachedTexture *cached = all->textures.liste_texture.suivant; cached != NULL; cached = cached->suivant)
+    {
+        octets += octetsTexture(cached->texture);
+    }
+    for (Text *text = all->liste_text.suivant; text != NULL; text = text->suivant)
+    {
+        octets += octetsTexture(text->texture);
+    }
+    return octets;
+}
+
+SDL_bool createCompteurs(Compteurs *compteurs, const char chemin[])
+{
+    compteurs->sortie = (SDL_strcmp(chemin, "-") == 0) ? stdout : fopen(chemin, "w");
+    if (compteurs->sortie == NULL)
+    {
+        fprintf(stderr, "Erreur fopen : impossible d'ecrire %s\n", chemin);
+        return SDL_FALSE;
+    }
+    fprintf(compteurs->sortie, "frame;etat;malloc;free;rejets_cercle;sat_complets;render_copy;render_geometry;mobs;fireplayers;texts;octets_textures\n");
+    return SDL_TRUE;
+}
+
+void destroyCompteurs(Everything *all)
+{
+    Compteurs *compteurs = &all->compteurs;
+    if (compteurs->sortie == NULL && !compteurs->zero_allocation)
+    {
+        return;
+    }
+    printf("Compteurs : %" SDL_PRIu64 " frames dont %" SDL_PRIu64 " de jeu, %" SDL_PRIu64 " avec des allocations\n",
+           compteurs->nb_frames, compteurs->nb_frames_jeu, compteurs->nb_frames_allocation);
+    if (compteurs->sortie != NULL && compteurs->sortie != stdout)
+    {
+        fclose(compteurs->sortie);
+    }
+    compteurs->sortie = NULL;
+}
+
+int quitAvantInit(Everything *all, int statut)
+{
+    /* sortie de main avant Init : seuls la trace, les compteurs et l'archive ont pu etre ouverts */
+    destroyTrace(&all->trace);
+    destroyCompteurs(all);
+    destroyArchive();
+    return statut;
+}
+
+void Quit(Everything *all, int statut)
+{
+    reportHorloge(&all->horloge);
+    closeReplay(&all->replay);
+    destroyTrace(&all->trace);
+    destroyCompteurs(all);
+    destroyChargeur(all);
+    destroyOrdonnanceur(all);
+
+    /* liberation de la RAM allouee */
+
+    while (all->liste_text.suivant != NULL)
+    {
+        destroyText(all->liste_text.suivant, all);
+    }
+    destroyFonts(all);
+    destroyLevel(all);
+    endSession(all);
+    destroyVagues(all);
+    if (all->projectiles.capacite > 0)
+    {
+        printf("Projectiles : %d/%d au maximum, %" SDL_PRIu64 " tires, %d refuses (noyau %s)\n", all->projectiles.nb_max,
+               all->projectiles.capacite, all->projectiles.nb_tires, all->projectiles.nb_refus, all->projectiles.nom_noyau);
+    }
+    destroyProjectiles(&all->projectiles);
+    destroyTextureCache(all);
+    destroyPool(&all->pool_mobs);
+    destroyPool(&all->pool_fireplayers);
+    destroyPool(&all->pool_texts);
+    destroySession(all);
+    destroyGrille(&all->grille_level);
+    destroyGrille(&all->grille_fireplayers);
+    destroyLot(&all->lot);
+    destroyLotSprites(&all->sprites);
+    destroyAtlas(all);
+    destroyArchive();
+
+    /* destruction du renderer et de la fenetre, fermeture de la SDL puis sortie du programme */
+
+    if (NULL != all->renderer)
+        SDL_DestroyRenderer(all->renderer);
+    if (NULL != all->window)
+        SDL_DestroyWindow(all->window);
+    TTF_Quit();
+    SDL_Quit();
+    printf("Libérations de toutes les ressources réussies\n");
+    exit(statut);
+}
+
+void loadOptions(Everything *all)
+{
+    all->input.key_A = SDLK_SPACE;
+    all->input.key_B = SDLK_d;
+    all->input.key_down = SDLK_KP_8;
+    all->input.key_L = SDLK_a;
+    all->input.key_left = SDLK_KP_7;
+    all->input.key_R = SDLK_z;
+    all->input.key_right = SDLK_KP_9;
+    all->input.key_select = SDLK_e;
+    all->input.key_start = SDLK_RETURN;
+    all->input.key_up = SDLK_KP_DIVIDE;
+    compileActions(&all->input);
+}
+
+FirePlayer *loadFirePlayer(Everything *all)
+{
+    FirePlayer *last = &all->liste_fireplayer;
+    while (last->suivant != NULL)
+    {
+        last = last->suivant;
+    }
+    last->suivant = allocPool(&all->pool_fireplayers);
+    if (last->suivant == NULL)
+    {
+        return NULL;
+    }
+    last->suivant->src_rect = all->session.src_fireplayer;
+    last->suivant->texture = all->session.texture_fireplayer;
+    last->suivant->dst_rect.h = 16;
+    last->suivant->dst_rect.w = 16;
+    last->suivant->dst_rect.x = -8;
+    last->suivant->dst_rect.y = -8;
+    last->suivant->suivant = NULL;
+    last->suivant->mort = SDL_FALSE;
+    last->suivant->hitbox.forme = &all->formes.fireplayer;
+    last->suivant->hitbox.x = 0;
+    last->suivant->hitbox.y = 0;
+    return last->suivant;
+}
+
+SDL_bool sortLimites(SDL_Rect *limites, Hitbox *hitbox, int bords)
+{
+    /* vrai si la boite englobante de la hitbox depasse un des bords choisis de l'aire de jeu ;
+       comme pour sat(), toucher un bord n'est pas le depasser */
+    const FormeHitbox *forme = hitbox->forme;
+    if ((bords & BORD_HAUT) && hitbox->y + forme->min_y < limites->y)
+    {
+        return SDL_TRUE;
+    }
+    if ((bords & BORD_BAS) && hitbox->y + forme->max_y > limites->y + limites->h)
+    {
+        return SDL_TRUE;
+    }
+    if ((bords & BORD_GAUCHE) && hitbox->x + forme->min_x < limites->x)
+    {
+        return SDL_TRUE;
+    }
+    if ((bords & BORD_DROITE) && hitbox->x + forme->max_x > limites->x + limites->w)
+    {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool collideObstacles(Hitbox *hitbox, LotHitbox *lot, int candidats[], Everything *all)
+{
+    /* obstacles statiques du level ; sans obstacle, ni requete dans la grille ni SAT.
+       lot et candidats sont les tampons de l'appelant : ceux de son thread pendant les phases paralleles */
+    int nb_candidats;
+    if (all->level.nb_hitboxes == 0)
+    {
+        return SDL_FALSE;
+    }
+    nb_candidats = queryGrilleCandidats(&all->grille_level, hitbox, candidats);
+    clearLot(lot);
+    for (int i = 0; i < nb_candidats; i++)
+    {
+        addLot(lot, all->grille_level.objets[candidats[i]], i);
+    }
+    return collideLot(hitbox, lot) > 0 ? SDL_TRUE : SDL_FALSE;
+}
+
+SDL_bool collideLevel(Hitbox *hitbox, Everything *all)
+{
+    /* le joueur ne peut ni sortir de l'aire de jeu ni entrer dans un obstacle */
+    SDL_bool collision;
+    DEBUT_TRACE(&all->trace, "collideLevel");
+    collision = (sortLimites(&all->level.limites, hitbox, TOUS_LES_BORDS) || collideObstacles(hitbox, &all->lot, all->grille_level.candidats, all)) ? SDL_TRUE : SDL_FALSE;
+    FIN_TRACE(&all->trace);
+    return collision;
+}
+
+void movePlayer(int x, int y, Everything *all)
+{
+    all->player.hitbox.x += x;
+    if (collideLevel(&all->player.hitbox, all))
+    {
+        all->player.hitbox.x -= x;
+    }
+
+    all->player.hitbox.y += y;
+    if (collideLevel(&all->player.hitbox, all))
+    {
+        all->player.hitbox.y -= y;
+    }
+}
+
+void moveFirePlayer(int x, int y, FirePlayer *fire)
+{
+    fire->hitbox.x += x;
+    fire->hitbox.y += y;
+}
+
+SDL_Rect *dstRect(SDL_Rect *dst_rect, Hitbox *hitbox)
+{
+    /* le sprite est centre sur la position de l'entite, portee par sa hitbox */
+    dst_rect->x = hitbox->x - dst_rect->w / 2;
+    dst_rect->y = hitbox->y - dst_rect->h / 2;
+    return dst_rect;
+}
+
+Mob *loadMob(Everything *all)
+{
+    Mob *mob = createMob(all);
+    if (mob != NULL)
+    {
+        all->dernier_mob->suivant = mob;
+        all->dernier_mob = mob;
+    }
+    return mob;
+}
+
+void firePlayer(Everything *all)
+{
+    FirePlayer *fire = loadFirePlayer(all);
+    if (fire != NULL)
+    {
+        moveFirePlayer(all->player.hitbox.x, all->player.hitbox.y, fire);
+    }
+    all->player.delay_fire = 10;
+}
+
+void loadPlayer(Everything *all)
+{
+    all->player.src_rect.h = 16;
+    all->player.src_rect.w = 16;
+    all->player.src_rect.x = 0;
+    all->player.src_rect.y = 0;
+    all->player.texture = acquireSprite("data/ship_player.bmp", &all->player.src_rect, all);
+    all->player.dst_rect.h = 16;
+    all->player.dst_rect.w = 16;
+    all->player.dst_rect.x = 152;
+    all->player.dst_rect.y = 172;
+    all->player.hitbox.forme = &all->formes.player;
+    all->player.hitbox.x = 160;
+    all->player.hitbox.y = 180;
+    all->player.PV = 5;
+    all->player.delay_fire = 0;
+    all->player.invincibility_frames = 0;
     all->player.fire_on_cooldown = SDL_FALSE;
     all->player.invicible = SDL_FALSE;
     all->liste_fireplayer.suivant = NULL;
     all->liste_fireplayer.texture = NULL;
     all->liste_mob.suivant = NULL;
     all->liste_mob.texture = NULL;
+    all->dernier_mob = &all->liste_mob;
+    all->projectiles.src_rect.h = 16;
+    all->projectiles.src_rect.w = 16;
+    all->projectiles.src_rect.x = 0;
+    all->projectiles.src_rect.y = 0;
+    all->projectiles.texture = acquireSprite("data/fire_player.bmp", &all->projectiles.src_rect, all);
+    all->projectiles.nb = 0;
+}
+
+void startSession(Everything *all)
+{
+    all->session.src_mob.h = 16;
+    all->session.src_mob.w = 16;
+    all->session.src_mob.x = 0;
+    all->session.src_mob.y = 0;
+    all->session.texture_mob = acquireSprite("data/ship_mob.bmp", &all->session.src_mob, all);
+    all->session.src_fireplayer.h = 16;
+    all->session.src_fireplayer.w = 16;
+    all->session.src_fireplayer.x = 0;
+    all->session.src_fireplayer.y = 0;
+    all->session.texture_fireplayer = acquireSprite("data/fire_player.bmp", &all->session.src_fireplayer, all);
+    loadPlayer(all);
+    resetVagues(all);
+    all->session.nb_parties += 1;
+}
+
+void loadNiveau(Everything *all)
+{
+    /* aire de jeu et obstacles statiques, indexes une fois pour toute la partie dans grille_level ;
+       sans fichier, tout l'ecran et aucun obstacle */
+    Level *level = &all->level;
+    char *texte = loadTexte(CHEMIN_NIVEAU), *ligne, *fin, *mots[3 + 2 * NB_POINTS_MAX_FORME], *fin_nombre;
+    int valeurs[2 + 2 * NB_POINTS_MAX_FORME], numero = 0, nb_mots, nb_valeurs, i;
+    SDL_Point points[NB_POINTS_MAX_FORME];
+    SDL_bool valide;
+    level->limites.x = 0;
+    level->limites.y = 0;
+    level->limites.w = 320;
+    level->limites.h = 240;
+    level->nb_hitboxes = 0;
+    level->hitboxes = SDL_calloc(NB_OBSTACLES_MAX, sizeof(Hitbox));
+    level->formes = SDL_calloc(NB_OBSTACLES_MAX, sizeof(FormeHitbox));
+    if (level->hitboxes == NULL || level->formes == NULL)
+    {
+        fprintf(stderr, "Erreur SDL_calloc : impossible d'allouer les obstacles\n");
+        SDL_free(texte);
+        return;
+    }
+    for (ligne = texte; ligne != NULL; ligne = fin)
+    {
+        fin = SDL_strchr(ligne, '\n');
+        if (fin != NULL)
+        {
+            *fin++ = '\0';
+        }
+        numero++;
+        nb_mots = decoupeLigne(ligne, mots, 3 + 2 * NB_POINTS_MAX_FORME);
+        if (nb_mots == 0)
+        {
+            continue;
+        }
+        nb_valeurs = nb_mots - 1;
+        valide = (nb_valeurs >= 2 && nb_valeurs <= 2 + 2 * NB_POINTS_MAX_FORME) ? SDL_TRUE : SDL_FALSE;
+        for (i = 0; valide && i < nb_valeurs; i++)
+        {
+            valeurs[i] = (int)SDL_strtol(mots[i + 1], &fin_nombre, 10);
+            valide = (*fin_nombre == '\0') ? SDL_TRUE : SDL_FALSE;
+        }
+        if (valide && SDL_strcmp(mots[0], "limites") == 0 && nb_valeurs == 4 && valeurs[2] > 0 && valeurs[3] > 0)
+        {
+            level->limites.x = valeurs[0];
+            level->limites.y = valeurs[1];
+            level->limites.w = valeurs[2];
+            level->limites.h = valeurs[3];
+            continue;
+        }
+        if (valide && level->nb_hitboxes < NB_OBSTACLES_MAX && SDL_strcmp(mots[0], "rectangle") == 0 && nb_valeurs == 4)
+        {
+            initFormeRectangle(&level->formes[level->nb_hitboxes], valeurs[2], valeurs[3]);
+        }
+        else if (valide && level->nb_hitboxes < NB_OBSTACLES_MAX && SDL_strcmp(mots[0], "polygone") == 0
+                 && nb_valeurs >= 8 && nb_valeurs % 2 == 0)
+        {
+            for (i = 0; i < (nb_valeurs - 2) / 2; i++)
+            {
+                points[i].x = valeurs[2 + 2 * i];
+                points[i].y = valeurs[3 + 2 * i];
+            }
+            initFormeHitbox(&level->formes[level->nb_hitboxes], points, (nb_valeurs - 2) / 2);
+        }
+        else
+        {
+            fprintf(stderr, "Erreur loadNiveau : ligne %d de %s ignoree\n", numero, CHEMIN_NIVEAU);
+            continue;
+        }
+        level->hitboxes[level->nb_hitboxes].x = valeurs[0];
+        level->hitboxes[level->nb_hitboxes].y = valeurs[1];
+        level->nb_hitboxes++;
+    }
+    SDL_free(texte);
+    clearGrille(&all->grille_level);
+    for (i = 0; i < level->nb_hitboxes; i++)
+    {
+        level->hitboxes[i].forme = &level->formes[i];
+        insertGrille(&all->grille_level, &level->hitboxes[i], &level->hitboxes[i]);
+    }
 }
 
 void loadLevel(Everything *all)
@@ -773,6 +5428,8 @@ void loadLevel(Everything *all)
     all->level.src_rect.w = 320;
     all->level.src_rect.x = 0;
     all->level.src_rect.y = 0;
+    all->level.rect_fond.w = 320;
+    all->level.rect_fond.h = 720;
     all->level.frame = 0;
     all->level.delay_button = 0;
     all->level.nb_hitboxes = 0;
@@ -860,6 +5517,18 @@ void loadLevel(Everything *all)
 
 void Init(Everything *all)
 {
+    /* en mode headless ni fenetre ni renderer ni TTF : seule la simulation tourne */
+
+    if (all->headless)
+    {
+        if (0 != SDL_Init(0))
+        {
+            fprintf(stderr, "Erreur SDL_Init : %s\n", SDL_GetError());
+            Quit(all, EXIT_FAILURE);
+        }
+        return;
+    }
+
     /* initialisation de la SDL et de la TTF */
 
     if (0 != SDL_Init(SDL_INIT_VIDEO))
@@ -893,7 +5562,7 @@ void Init(Everything *all)
     /* chargement et affichage de l'icone de la fenetre */
 
     SDL_Surface *icone;
-    icone = SDL_LoadBMP("icone.bmp");
+    icone = SDL_LoadBMP_RW(openAsset(CHEMIN_ICONE), 1);
     if (NULL == icone)
     {
         fprintf(stderr, "Erreur SDL_LoadBMP : %s\n", SDL_GetError());
@@ -903,35 +5572,56 @@ void Init(Everything *all)
     SDL_FreeSurface(icone);
 }
 
+int listeTirs(Everything *all)
+{
+    /* range les tirs dans ordonnanceur->tirs, dans l'ordre de la liste, pour les decouper en taches */
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    int nb = 0;
+    for (FirePlayer *fire = all->liste_fireplayer.suivant; fire != NULL && nb < ordonnanceur->capacite_entites; fire = fire->suivant)
+    {
+        ordonnanceur->tirs[nb++] = fire;
+    }
+    return nb;
+}
+
+int listeMobs(Everything *all)
+{
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    int nb = 0;
+    for (Mob *mob = all->liste_mob.suivant; mob != NULL && nb < ordonnanceur->capacite_entites; mob = mob->suivant)
+    {
+        ordonnanceur->mobs[nb++] = mob;
+    }
+    return nb;
+}
+
+void tacheTirs(Everything *all, ContexteTravailleur *contexte, int debut, int fin)
+{
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    FirePlayer *fire;
+    for (int i = debut; i < fin; i++)
+    {
+        fire = ordonnanceur->tirs[i];
+        moveFirePlayer(0, -3, fire);
+        ordonnanceur->sortis[i] = sortLimites(&all->level.limites, &fire->hitbox, TOUS_LES_BORDS)
+            || collideObstacles(&fire->hitbox, &contexte->lot, contexte->candidats, all);
+    }
+}
+
 void updateFirePlayers(Everything *all)
 {
-    FirePlayer *fire = &all->liste_fireplayer;
-    int i;
-    SDL_bool destroy = SDL_FALSE;
-    while (fire->suivant != NULL)
+    /* deplacements et tests en parallele, puis les tirs sortis retires en un seul parcours */
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    int nb_tirs = listeTirs(all);
+    runTaches(ordonnanceur, tacheTirs, nb_tirs, TAILLE_TACHE);
+    for (int i = 0; i < nb_tirs; i++)
     {
-        moveFirePlayer(0, -3, fire->suivant, all);
-        if (fire->suivant->texture != NULL)
-        {
-            SDL_RenderCopy(all->renderer, fire->suivant->texture, &fire->suivant->src_rect, &fire->suivant->dst_rect);
-        }
-        for (i = 0; i < all->level.nb_hitboxes-1; i++)
-        {
-            if (sat(&fire->suivant->hitbox, &all->level.hitboxes[i]))
-            {
-                destroy = SDL_TRUE;
-            }
-        }
-        if (destroy)
+        if (ordonnanceur->sortis[i])
         {
-            destroyFirePlayer(fire->suivant, all);
-            destroy = SDL_FALSE;
-        }
-        else
-        {
-            fire = fire->suivant;
+            killFirePlayer(ordonnanceur->tirs[i], all);
         }
     }
+    sweepFirePlayers(all);
 }
 
 void updatePlayer(Everything *all)
@@ -1005,23 +5695,83 @@ void updatePlayer(Everything *all)
             all->player.invicible = SDL_FALSE;
         }
     }
+}
+
+void drawPlayer(Everything *all)
+{
+    /* clignotement pendant l'invincibilite */
+    if (all->player.texture == NULL)
+    {
+        return;
+    }
+    if (!all->player.invicible || all->player.invincibility_frames % 2 == 0)
+    {
+        addSprite(all->player.texture, &all->player.src_rect, dstRect(&all->player.dst_rect, &all->player.hitbox), COUCHE_PLAYER, all);
+    }
+}
 
-    /* update player aff */
+void drawFirePlayers(Everything *all)
+{
+    for (FirePlayer *fire = all->liste_fireplayer.suivant; fire != NULL; fire = fire->suivant)
+    {
+        addSprite(fire->texture, &fire->src_rect, dstRect(&fire->dst_rect, &fire->hitbox), COUCHE_FIREPLAYERS, all);
+    }
+}
 
-    if (!all->player.invicible)
+void drawMobs(Everything *all)
+{
+    for (Mob *mob = all->liste_mob.suivant; mob != NULL; mob = mob->suivant)
     {
-        if (all->player.texture != NULL)
-        {
-            SDL_RenderCopy(all->renderer, all->player.texture, &all->player.src_rect, &all->player.dst_rect);
-        }
+        addSprite(mob->texture, &mob->src_rect, dstRect(&mob->dst_rect, &mob->hitbox), COUCHE_MOBS, all);
     }
-    else
+}
+
+void tacheGrille(Everything *all, ContexteTravailleur *contexte, int debut, int fin)
+{
+    /* le placement dans la grille n'utilise pas les tampons du travailleur */
+    (void)contexte;
+    for (int i = debut; i < fin; i++)
     {
-        if (all->player.invincibility_frames % 2 == 0)
+        placeGrille(&all->grille_fireplayers, i, all->ordonnanceur.tirs[i], &all->ordonnanceur.tirs[i]->hitbox);
+    }
+}
+
+void tacheMobs(Everything *all, ContexteTravailleur *contexte, int debut, int fin)
+{
+    /* deplacement et narrow phase d'un bloc de mobs ; les tirs touches sont notes dans le
+       contexte du thread, sans rien detruire : c'est la fusion serie qui decide */
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    Grille *grille = &all->grille_fireplayers;
+    LotHitbox *lot = &contexte->lot;
+    FirePlayer *fire;
+    Mob *mob;
+    int nb_candidats, candidat;
+    for (int i = debut; i < fin; i++)
+    {
+        mob = ordonnanceur->mobs[i];
+        moveMob(0, 1, mob);
+        /* les mobs entrent par le haut : seuls les autres bords les font disparaitre */
+        ordonnanceur->sortis[i] = sortLimites(&all->level.limites, &mob->hitbox, BORD_BAS | BORD_GAUCHE | BORD_DROITE)
+            || collideObstacles(&mob->hitbox, lot, contexte->candidats, all);
+        nb_candidats = queryGrilleCandidats(grille, &mob->hitbox, contexte->candidats);
+        clearLot(lot);
+        for (int c = 0; c < nb_candidats; c++)
+        {
+            candidat = contexte->candidats[c];
+            fire = grille->objets[candidat];
+            addLot(lot, &fire->hitbox, candidat);
+        }
+        ordonnanceur->touches_contexte[i] = contexte->id;
+        ordonnanceur->touches_debut[i] = contexte->nb_touches;
+        ordonnanceur->touches_nb[i] = 0;
+        if (collideLot(&mob->hitbox, lot) > 0)
         {
-            if (all->player.texture != NULL)
+            for (int j = 0; j < lot->nb; j++)
             {
-                SDL_RenderCopy(all->renderer, all->player.texture, &all->player.src_rect, &all->player.dst_rect);
+                if (hitLot(lot, j) && addTouche(contexte, lot->etiquettes[j]))
+                {
+                    ordonnanceur->touches_nb[i] += 1;
+                }
             }
         }
     }
@@ -1029,56 +5779,127 @@ void updatePlayer(Everything *all)
 
 void updateMobs(Everything *all)
 {
-    if (all->liste_mob.suivant == NULL)
+    updateVagues(all);
+
+    Ordonnanceur *ordonnanceur = &all->ordonnanceur;
+    Grille *grille = &all->grille_fireplayers;
+    Mob *mob;
+    FirePlayer *fire;
+    int i, nb_tirs, nb_mobs, *touches;
+
+    /* les tirs ne bougent plus pendant cette phase : on les range une fois dans la grille,
+       places en parallele puis chaines en serie ; tacheMobs deplace chaque mob juste avant
+       de le tester, d'ou un seul span pour les deux */
+    DEBUT_TRACE(&all->trace, "deplacement et collisions mobs");
+    clearGrille(grille);
+    nb_tirs = listeTirs(all);
+    if (nb_tirs > grille->capacite_objets)
+    {
+        fprintf(stderr, "Erreur dans updateMobs : grille pleine (%d objets)\n", grille->capacite_objets);
+        nb_tirs = grille->capacite_objets;
+    }
+    grille->nb_objets = nb_tirs;
+    runTaches(ordonnanceur, tacheGrille, nb_tirs, TAILLE_TACHE);
+    chaineGrille(grille);
+
+    nb_mobs = listeMobs(all);
+    for (i = 0; i < ordonnanceur->nb_threads; i++)
     {
-        spawnMobs(all);
+        ordonnanceur->contextes[i].nb_touches = 0;
     }
+    runTaches(ordonnanceur, tacheMobs, nb_mobs, TAILLE_TACHE);
 
-    Mob *mob = &all->liste_mob;
-    FirePlayer *fire = &all->liste_fireplayer;
-    int i;
-    SDL_bool destroy = SDL_FALSE;
-    while (mob->suivant != NULL)
+    /* fusion dans l'ordre de la liste, comme en serie : un tir deja tue par un mob
+       precedent ne compte plus ; les morts sont retires ensuite, en un parcours par liste */
+    for (i = 0; i < nb_mobs; i++)
     {
-        moveMob(0, 1, mob->suivant, all);
-        if (mob->suivant->texture != NULL)
-        {
-            SDL_RenderCopy(all->renderer, mob->suivant->texture, &mob->suivant->src_rect, &mob->suivant->dst_rect);
-        }
-        for (i = 0; i < all->level.nb_hitboxes-1; i++)
+        mob = ordonnanceur->mobs[i];
+        touches = ordonnanceur->contextes[ordonnanceur->touches_contexte[i]].touches + ordonnanceur->touches_debut[i];
+        for (int j = 0; j < ordonnanceur->touches_nb[i]; j++)
         {
-            if (sat(&mob->suivant->hitbox, &all->level.hitboxes[i]))
+            fire = grille->objets[touches[j]];
+            if (!fire->mort)
             {
-                destroy = SDL_TRUE;
+                mob->PV -= 1;
+                killFirePlayer(fire, all);
             }
         }
-        fire = &all->liste_fireplayer;
-        while (fire->suivant != NULL)
+        if (ordonnanceur->sortis[i] || mob->PV <= 0)
         {
-            if (sat(&mob->suivant->hitbox, &fire->suivant->hitbox))
+            killMob(mob, all);
+        }
+    }
+    sweepFirePlayers(all);
+    sweepMobs(all);
+    FIN_TRACE(&all->trace);
+}
+
+void fireEmetteur(Mob *mob, Everything *all)
+{
+    /* une salve depuis le centre du mob selon le motif de son emetteur */
+    Emetteur *emetteur = &mob->emetteur;
+    Projectiles *projectiles = &all->projectiles;
+    int x = mob->hitbox.x, y = mob->hitbox.y, direction;
+    switch (emetteur->tir)
+    {
+        case TIR_RADIAL :
+            for (int k = 0; k < NB_BRANCHES_RADIAL; k++)
             {
-                mob->suivant->PV -= 1;
-                destroyFirePlayer(fire->suivant, all);
+                addProjectile(projectiles, x, y, k * NB_DIRECTIONS / NB_BRANCHES_RADIAL);
             }
-            else
+            break;
+        case TIR_VISE :             /* eventail centre sur le joueur */
+            direction = (int)SDL_floor(SDL_atan2(all->player.hitbox.y - y, all->player.hitbox.x - x) * NB_DIRECTIONS / 6.283185307179586 + 0.5);
+            for (int k = 0; k < NB_BRANCHES_VISE; k++)
             {
-                fire = fire->suivant;
+                addProjectile(projectiles, x, y, direction + (k - NB_BRANCHES_VISE / 2) * ECART_VISE);
             }
-        }
-        if (mob->suivant->PV <= 0)
-        {
-            destroy = SDL_TRUE;
-        }
-        if (destroy)
-        {
-            destroyMob(mob->suivant, all);
-            destroy = SDL_FALSE;
-        }
-        else
+            break;
+        case TIR_SPIRALE :          /* les bras tournent de PAS_SPIRALE directions a chaque salve */
+            for (int k = 0; k < NB_BRANCHES_SPIRALE; k++)
+            {
+                addProjectile(projectiles, x, y, emetteur->direction + k * NB_DIRECTIONS / NB_BRANCHES_SPIRALE);
+            }
+            emetteur->direction = (emetteur->direction + PAS_SPIRALE) & (NB_DIRECTIONS - 1);
+            break;
+        default :
+            break;
+    }
+}
+
+void updateProjectiles(Everything *all)
+{
+    /* salves des emetteurs dans l'ordre de la liste, puis un pas de tous les projectiles ;
+       le joueur invincible n'est pas une cible, les projectiles le traversent */
+    Player *player = &all->player;
+    for (Mob *mob = all->liste_mob.suivant; mob != NULL; mob = mob->suivant)
+    {
+        if (mob->emetteur.tir != TIR_AUCUN && --mob->emetteur.minuterie <= 0)
         {
-            mob = mob->suivant;
+            fireEmetteur(mob, all);
+            mob->emetteur.minuterie = mob->emetteur.periode;
         }
     }
+    if (stepProjectiles(&all->projectiles, &all->level.limites, player->invicible ? NULL : &player->hitbox) > 0)
+    {
+        player->invicible = SDL_TRUE;
+        player->invincibility_frames = 40;
+        player->PV -= 1;
+    }
+}
+
+void drawProjectiles(Everything *all)
+{
+    /* le sprite du tir du joueur, reduit et teinte */
+    Projectiles *projectiles = &all->projectiles;
+    SDL_Color rouge = {255, 80, 80, 255};
+    SDL_Rect dst_rect = {0, 0, 2 * RAYON_PROJECTILE + 2, 2 * RAYON_PROJECTILE + 2};
+    for (int i = 0; i < projectiles->nb; i++)
+    {
+        dst_rect.x = (projectiles->x[i] >> VIRGULE_PROJECTILE) - dst_rect.w / 2;
+        dst_rect.y = (projectiles->y[i] >> VIRGULE_PROJECTILE) - dst_rect.h / 2;
+        addSpriteCouleur(projectiles->texture, &projectiles->src_rect, &dst_rect, COUCHE_PROJECTILES, rouge, all);
+    }
 }
 
 void updateButton(Everything *all)
@@ -1120,77 +5941,7 @@ void updateButton(Everything *all)
 
 void updateGame(Everything *all)
 {
-    /* On charge les ressources si elles ne sont pas déjà chargées */
-
-    if (all->level.texture == NULL)
-    {
-        all->level.texture = loadImage("data/background.bmp", all->renderer);
-    }
-    if (all->level.hitboxes == NULL)
-    {
-        all->level.nb_hitboxes = 4;
-        Hitbox hitboxes[4];
-        all->level.hitboxes = SDL_malloc(sizeof(hitboxes));
-        SDL_Point points[4];
-
-        all->level.hitboxes[0].nb_points = 4;
-        all->level.hitboxes[0].cercle_x = 160;
-        all->level.hitboxes[0].cercle_y = -5;
-        all->level.hitboxes[0].cercle_rayon = 170;
-        all->level.hitboxes[0].points = SDL_malloc(sizeof(points));
-        all->level.hitboxes[0].points[0].x = 0;
-        all->level.hitboxes[0].points[0].y = -10;
-        all->level.hitboxes[0].points[1].x = 320;
-        all->level.hitboxes[0].points[1].y = -10;
-        all->level.hitboxes[0].points[2].x = 320;
-        all->level.hitboxes[0].points[2].y = 0;
-        all->level.hitboxes[0].points[3].x = 0;
-        all->level.hitboxes[0].points[3].y = 0;
-
-        all->level.hitboxes[1].nb_points = 4;
-        all->level.hitboxes[1].cercle_x = 325;
-        all->level.hitboxes[1].cercle_y = 120;
-        all->level.hitboxes[1].cercle_rayon = 130;
-        all->level.hitboxes[1].points = SDL_malloc(sizeof(points));
-        all->level.hitboxes[1].points[0].x = 320;
-        all->level.hitboxes[1].points[0].y = 0;
-        all->level.hitboxes[1].points[1].x = 330;
-        all->level.hitboxes[1].points[1].y = 0;
-        all->level.hitboxes[1].points[2].x = 330;
-        all->level.hitboxes[1].points[2].y = 240;
-        all->level.hitboxes[1].points[3].x = 320;
-        all->level.hitboxes[1].points[3].y = 240;
-
-        all->level.hitboxes[2].nb_points = 4;
-        all->level.hitboxes[2].cercle_x = 160;
-        all->level.hitboxes[2].cercle_y = 245;
-        all->level.hitboxes[2].cercle_rayon = 170;
-        all->level.hitboxes[2].points = SDL_malloc(sizeof(points));
-        all->level.hitboxes[2].points[0].x = 0;
-        all->level.hitboxes[2].points[0].y = 240;
-        all->level.hitboxes[2].points[1].x = 320;
-        all->level.hitboxes[2].points[1].y = 240;
-        all->level.hitboxes[2].points[2].x = 320;
-        all->level.hitboxes[2].points[2].y = 250;
-        all->level.hitboxes[2].points[3].x = 0;
-        all->level.hitboxes[2].points[3].y = 250;
-
-        all->level.hitboxes[3].nb_points = 4;
-        all->level.hitboxes[3].cercle_x = -5;
-        all->level.hitboxes[3].cercle_y = 120;
-        all->level.hitboxes[3].cercle_rayon = 130;
-        all->level.hitboxes[3].points = SDL_malloc(sizeof(points));
-        all->level.hitboxes[3].points[0].x = -10;
-        all->level.hitboxes[3].points[0].y = 0;
-        all->level.hitboxes[3].points[1].x = 0;
-        all->level.hitboxes[3].points[1].y = 0;
-        all->level.hitboxes[3].points[2].x = 0;
-        all->level.hitboxes[3].points[2].y = 240;
-        all->level.hitboxes[3].points[3].x = -10;
-        all->level.hitboxes[3].points[3].y = 240;
-    }
-
-    /* Affichage du Level */
+    /* Defilement du Level */
 
     if (all->level.frame >= 3)
     {
@@ -1202,233 +5953,100 @@ void updateGame(Everything *all)
         all->level.frame = 0;
     }
     all->level.frame += 1;
-    if (all->level.texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.texture, &all->level.src_rect, NULL);
-    }
 }
 
-void updateMainmenu(Everything *all)
+void drawBackground(Everything *all)
 {
-    /* On charge les ressources si elles ne sont pas déjà chargées */
-    
+    SDL_Rect src_rect = all->level.src_rect, dst_rect = {0, 0, 320, 240};
     if (all->level.texture == NULL)
     {
-        all->level.texture = loadImage("data/background.bmp", all->renderer);
-    }
-    if (all->level.title == NULL)
-    {
-        all->level.title = loadText(all->fonts.titles, "Space Shooter", all->fonts.vert, all);
-        all->level.title->dst_rect.x = 160 - (all->level.title->dst_rect.w / 2);
-        all->level.title->dst_rect.y += 53;
+        all->level.rect_fond.x = 0;
+        all->level.rect_fond.y = 0;
+        all->level.texture = acquireSprite("data/background.bmp", &all->level.rect_fond, all);
     }
-    if (all->level.start_game.text == NULL)
-    {
-        all->level.start_game.text = loadText(all->fonts.menu_button, "Start Game", all->fonts.vert_clair, all);
-        all->level.start_game.text->dst_rect.x = 160 - (all->level.start_game.text->dst_rect.w / 2);
-        all->level.start_game.text->dst_rect.y += 130;
-    }
-    if (all->level.settings.text == NULL)
-    {
-        all->level.settings.text = loadText(all->fonts.menu_button, "Options", all->fonts.vert_clair, all);
-        all->level.settings.text->dst_rect.x = 160 - (all->level.settings.text->dst_rect.w / 2);
-        all->level.settings.text->dst_rect.y += 160;
-    }
-    if (all->level.quit_game.text == NULL)
+    src_rect.x += all->level.rect_fond.x;
+    src_rect.y += all->level.rect_fond.y;
+    addSprite(all->level.texture, &src_rect, &dst_rect, COUCHE_FOND, all);
+}
+
+void drawText(Text *text, Everything *all)
+{
+    /* le texte peut ne pas encore exister : il est charge au premier affichage de son ecran */
+    if (text != NULL && text->texture != NULL)
     {
-        all->level.quit_game.text = loadText(all->fonts.menu_button, "Quit Game", all->fonts.vert_clair, all);
-        all->level.quit_game.text->dst_rect.x = 160 - (all->level.quit_game.text->dst_rect.w / 2);
-        all->level.quit_game.text->dst_rect.y += 190;
+        drawLotSprites(all);    /* le fond deja collecte doit passer sous le texte */
+        SDL_RenderCopy(all->renderer, text->texture, NULL, &text->dst_rect);
+        all->sprites.nb_copies++;
     }
+}
+
+void drawHUD(Everything *all)
+{
+    /* texte change a chaque frame : atlas de glyphes plutot que loadText */
+    char texte[16];
+    SDL_snprintf(texte, sizeof(texte), "PV %d", all->player.PV);
+    drawString(&all->fonts.atlas_menu_button, texte, 4, 2, all->fonts.vert_clair, all);
+}
+
+void drawGame(Everything *all)
+{
+    drawBackground(all);
+    drawFirePlayers(all);
+    drawPlayer(all);
+    drawMobs(all);
+    drawProjectiles(all);
+    drawHUD(all);
+}
+
+void updateMainmenu(Everything *all)
+{
     if (all->level.selected_button == NULL)
     {
         all->level.selected_button = &all->level.start_game;
     }
     updateButton(all);
+}
 
+void drawMainmenu(Everything *all)
+{
     /* Affichage du Menu Principal */
 
-    if (all->level.texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.texture, &all->level.src_rect, NULL);
-    }
-    if (all->level.title->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.title->texture, NULL, &all->level.title->dst_rect);
-    }
-    if (all->level.start_game.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.start_game.text->texture, NULL, &all->level.start_game.text->dst_rect);
-    }
-    if (all->level.settings.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.settings.text->texture, NULL, &all->level.settings.text->dst_rect);
-    }
-    if (all->level.quit_game.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.quit_game.text->texture, NULL, &all->level.quit_game.text->dst_rect);
-    }
+    drawBackground(all);
+    drawText(all->level.title, all);
+    drawText(all->level.start_game.text, all);
+    drawText(all->level.settings.text, all);
+    drawText(all->level.quit_game.text, all);
 }
 
-void updateGameover(Everything *all)
+void drawGameover(Everything *all)
 {
-    /* On charge les ressources si elles ne sont pas déjà chargées */
-
-    if (all->level.texture == NULL)
-    {
-        all->level.texture = loadImage("data/background.bmp", all->renderer);
-    }
-    if (all->level.game_over == NULL)
-    {
-        all->level.game_over = loadText(all->fonts.titles, "Game Over", all->fonts.rouge, all);
-        all->level.game_over->dst_rect.x = 160 - (all->level.game_over->dst_rect.w / 2);
-        all->level.game_over->dst_rect.y += 95;
-    }
-
     /* Affichage de l'écran de Game Over */
 
-    if (all->level.texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.texture, &all->level.src_rect, NULL);
-    }
-    if (all->level.game_over->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.game_over->texture, NULL, &all->level.game_over->dst_rect);
-    }
+    drawBackground(all);
+    drawText(all->level.game_over, all);
 }
 
 void updateSettings(Everything *all)
 {
-    /* On charge les ressources si elles ne sont pas déjà chargées */
-    
-    if (all->level.texture == NULL)
-    {
-        all->level.texture = loadImage("data/background.bmp", all->renderer);
-    }
-    if (all->level.settings_title == NULL)
-    {
-        all->level.settings_title = loadText(all->fonts.secondary_titles, "Options", all->fonts.vert_clair, all);
-        all->level.settings_title->dst_rect.x = 160 - (all->level.settings_title->dst_rect.w / 2);
-        all->level.settings_title->dst_rect.y = 50;
-    }
-    if (all->level.control_settings.text == NULL)
-    {
-        all->level.control_settings.text = loadText(all->fonts.menu_button, "Keyboard Settings", all->fonts.vert_clair, all);
-        all->level.control_settings.text->dst_rect.x = 160 - (all->level.control_settings.text->dst_rect.w / 2);
-        all->level.control_settings.text->dst_rect.y = 130;
-    }
-    if (all->level.back_to_menu.text == NULL)
-    {
-        all->level.back_to_menu.text = loadText(all->fonts.menu_button, "Back To Menu", all->fonts.vert_clair, all);
-        all->level.back_to_menu.text->dst_rect.x = 160 - (all->level.back_to_menu.text->dst_rect.w / 2);
-        all->level.back_to_menu.text->dst_rect.y = 160;
-    }
     if (all->level.selected_button == NULL)
     {
         all->level.selected_button = &all->level.control_settings;
     }
     updateButton(all);
+}
 
+void drawSettings(Everything *all)
+{
     /* Affichage du Menu Principal */
 
-    if (all->level.texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.texture, &all->level.src_rect, NULL);
-    }
-    if (all->level.settings_title->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.settings_title->texture, NULL, &all->level.settings_title->dst_rect);
-    }
-    if (all->level.control_settings.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.control_settings.text->texture, NULL, &all->level.control_settings.text->dst_rect);
-    }
-    if (all->level.back_to_menu.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.back_to_menu.text->texture, NULL, &all->level.back_to_menu.text->dst_rect);
-    }
+    drawBackground(all);
+    drawText(all->level.settings_title, all);
+    drawText(all->level.control_settings.text, all);
+    drawText(all->level.back_to_menu.text, all);
 }
 
 void updateControlsettings(Everything *all)
 {
-    /* On charge les ressources si elles ne sont pas déjà chargées */
-    
-    if (all->level.texture == NULL)
-    {
-        all->level.texture = loadImage("data/background.bmp", all->renderer);
-    }
-    if (all->level.control_settings_title == NULL)
-    {
-        all->level.control_settings_title = loadText(all->fonts.secondary_titles, "Keyboard Settings", all->fonts.vert_clair, all);
-        all->level.control_settings_title->dst_rect.x = 160 - (all->level.control_settings_title->dst_rect.w / 2);
-        all->level.control_settings_title->dst_rect.y = 20;
-    }
-    if (all->level.chg_up.text == NULL)
-    {
-        all->level.chg_up.text = loadText(all->fonts.menu_button, "Up", all->fonts.vert_clair, all);
-        all->level.chg_up.text->dst_rect.x = 40;
-        all->level.chg_up.text->dst_rect.y = 60;
-    }
-    if (all->level.chg_down.text == NULL)
-    {
-        all->level.chg_down.text = loadText(all->fonts.menu_button, "Down", all->fonts.vert_clair, all);
-        all->level.chg_down.text->dst_rect.x = 40;
-        all->level.chg_down.text->dst_rect.y = 80;
-    }
-    if (all->level.chg_left.text == NULL)
-    {
-        all->level.chg_left.text = loadText(all->fonts.menu_button, "Left", all->fonts.vert_clair, all);
-        all->level.chg_left.text->dst_rect.x = 40;
-        all->level.chg_left.text->dst_rect.y = 100;
-    }
-    if (all->level.chg_right.text == NULL)
-    {
-        all->level.chg_right.text = loadText(all->fonts.menu_button, "Right", all->fonts.vert_clair, all);
-        all->level.chg_right.text->dst_rect.x = 40;
-        all->level.chg_right.text->dst_rect.y = 120;
-    }
-    if (all->level.chg_A.text == NULL)
-    {
-        all->level.chg_A.text = loadText(all->fonts.menu_button, "A", all->fonts.vert_clair, all);
-        all->level.chg_A.text->dst_rect.x = 40;
-        all->level.chg_A.text->dst_rect.y = 140;
-    }
-    if (all->level.chg_B.text == NULL)
-    {
-        all->level.chg_B.text = loadText(all->fonts.menu_button, "B", all->fonts.vert_clair, all);
-        all->level.chg_B.text->dst_rect.x = 200;
-        all->level.chg_B.text->dst_rect.y = 60;
-    }
-    if (all->level.chg_L.text == NULL)
-    {
-        all->level.chg_L.text = loadText(all->fonts.menu_button, "L", all->fonts.vert_clair, all);
-        all->level.chg_L.text->dst_rect.x = 200;
-        all->level.chg_L.text->dst_rect.y = 80;
-    }
-    if (all->level.chg_R.text == NULL)
-    {
-        all->level.chg_R.text = loadText(all->fonts.menu_button, "R", all->fonts.vert_clair, all);
-        all->level.chg_R.text->dst_rect.x = 200;
-        all->level.chg_R.text->dst_rect.y = 100;
-    }
-    if (all->level.chg_start.text == NULL)
-    {
-        all->level.chg_start.text = loadText(all->fonts.menu_button, "Start", all->fonts.vert_clair, all);
-        all->level.chg_start.text->dst_rect.x = 200;
-        all->level.chg_start.text->dst_rect.y = 120;
-    }
-    if (all->level.chg_select.text == NULL)
-    {
-        all->level.chg_select.text = loadText(all->fonts.menu_button, "Select", all->fonts.vert_clair, all);
-        all->level.chg_select.text->dst_rect.x = 200;
-        all->level.chg_select.text->dst_rect.y = 140;
-    }
-    if (all->level.control_back_to_settings.text == NULL)
-    {
-        all->level.control_back_to_settings.text = loadText(all->fonts.menu_button, "Save and Exit", all->fonts.vert_clair, all);
-        all->level.control_back_to_settings.text->dst_rect.x = 160 - (all->level.control_back_to_settings.text->dst_rect.w / 2);
-        all->level.control_back_to_settings.text->dst_rect.y = 200;
-    }
     if (all->level.selected_button == NULL)
     {
         all->level.selected_button = &all->level.chg_up;
@@ -1482,371 +6100,771 @@ void updateControlsettings(Everything *all)
             }
             else if (all->level.selected_button == &all->level.chg_start)
             {
-                all->input.key_start = all->input.wanted_input;
+                all->input.key_start = all->input.wanted_input;
+            }
+            compileActions(&all->input);
+            all->input.waiting_for_input = SDL_FALSE;
+        }
+        else if (all->level.selected_button != &all->level.control_back_to_settings)
+        {
+            all->input.waiting_for_input = SDL_TRUE;
+        }
+    }
+}
+
+void drawControlsettings(Everything *all)
+{
+    /* Affichage du Menu Principal */
+
+    drawBackground(all);
+    drawText(all->level.control_settings_title, all);
+    drawText(all->level.chg_up.text, all);
+    drawText(all->level.chg_down.text, all);
+    drawText(all->level.chg_left.text, all);
+    drawText(all->level.chg_right.text, all);
+    drawText(all->level.chg_A.text, all);
+    drawText(all->level.chg_B.text, all);
+    drawText(all->level.chg_L.text, all);
+    drawText(all->level.chg_R.text, all);
+    drawText(all->level.chg_start.text, all);
+    drawText(all->level.chg_select.text, all);
+    drawText(all->level.control_back_to_settings.text, all);
+}
+
+void updateGameState(Everything *all)
+{
+    switch (all->game_state)
+    {
+        case 0 :        /* Title Screen */
+        {
+            if (all->input.start)
+            {
+                if (all->level.selected_button == &all->level.start_game)
+                {
+                    /* Start Game */
+                    changeScene(all, 1);
+                    startSession(all);
+                    all->level.selected_button = NULL;
+                }
+                else if (all->level.selected_button == &all->level.settings)
+                {
+                    /* Go to the Settings Menu */
+                    changeScene(all, 3);
+                    all->level.selected_button = NULL;
+                }
+                else if (all->level.selected_button == &all->level.quit_game)
+                {
+                    /* Quit Game */
+                    all->input.quit = SDL_TRUE;
+                    all->level.selected_button = NULL;
+                }
+            }
+            break;
+        }
+        case 1 :        /* Game */
+        {
+            if (all->player.PV <= 0)
+            {
+                /* Game Over */
+                changeScene(all, 2);
+                endSession(all);
+            }
+            break;
+        }
+        case 2 :        /* Game Over Screen */
+        {
+            if (all->input.start)
+            {
+                /* Return to Menu */
+                changeScene(all, 0);
+            }
+            break;
+        }
+        case 3 :        /* Settings Menu */
+        {
+            if (all->input.start)
+            {
+                if (all->level.selected_button == &all->level.control_settings)
+                {
+                    /* Go to the Control Settings */
+                    changeScene(all, 4);
+                    all->level.selected_button = NULL;
+                }
+                else if (all->level.selected_button == &all->level.back_to_menu)
+                {
+                    /* Go back to the Main Menu */
+                    changeScene(all, 0);
+                    all->level.selected_button = NULL;
+                }
+            }
+            break;
+        }
+        case 4 :        /* Control Settings */
+        {
+            if (all->input.start)
+            {
+                if (all->level.selected_button == &all->level.control_back_to_settings)
+                {
+                    /* Go to Settings */
+                    changeScene(all, 3);
+                    all->level.selected_button = NULL;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void updateGameplay(Everything *all)
+{
+    DEBUT_TRACE(&all->trace, "updateGame");
+    updateGame(all);
+    FIN_TRACE(&all->trace);
+    DEBUT_TRACE(&all->trace, "updatePlayer");
+    updatePlayer(all);
+    FIN_TRACE(&all->trace);
+    DEBUT_TRACE(&all->trace, "updateMobs");
+    updateMobs(all);
+    FIN_TRACE(&all->trace);
+    DEBUT_TRACE(&all->trace, "updateProjectiles");
+    updateProjectiles(all);
+    FIN_TRACE(&all->trace);
+}
+
+void loadScenes(Everything *all)
+{
+    /* table des ecrans ; leurs textes viennent de loadLabels ou du thread de chargement */
+    Scene scenes[NB_SCENES] = {
+        {"updateMainmenu", updateMainmenu, drawMainmenu},
+        {"updateGameplay", updateGameplay, drawGame},
+        {"updateGameover", NULL, drawGameover},
+        {"updateSettings", updateSettings, drawSettings},
+        {"updateControlsettings", updateControlsettings, drawControlsettings},
+        {"updateChargement", NULL, drawChargement}
+    };
+    for (int i = 0; i < NB_SCENES; i++)
+    {
+        all->scenes[i] = scenes[i];
+    }
+    changeScene(all, all->game_state);
+}
+
+void updateSimulation(Everything *all)
+{
+    /* un pas de simulation de l'ecran courant puis les transitions, sans aucun affichage */
+    if (all->scene->update != NULL)
+    {
+        DEBUT_TRACE(&all->trace, all->scene->nom);
+        all->scene->update(all);
+        FIN_TRACE(&all->trace);
+    }
+    DEBUT_TRACE(&all->trace, "updateGameState");
+    updateGameState(all);
+    FIN_TRACE(&all->trace);
+}
+
+void updateTick(Everything *all)
+{
+    DEBUT_TRACE(&all->trace, "tick");
+    DEBUT_TRACE(&all->trace, "updateEvent");
+    updateEvent(&all->input);
+    FIN_TRACE(&all->trace);
+    if (all->input.select && all->game_state != 4)
+    {
+        /* avant la lecture d'un replay : l'overlay suit le clavier, pas les entrees rejouees ;
+           dans le menu des controles, Select est une touche a reassigner comme les autres */
+        all->compteurs.affiche = !all->compteurs.affiche;
+    }
+    if (all->game_state == ETAT_CHARGEMENT)
+    {
+        /* rien a simuler ni a enregistrer : les replays commencent au menu quelle que soit
+           la duree du chargement */
+        FIN_TRACE(&all->trace);
+        return;
+    }
+    if (all->replay.lecture && !readReplay(&all->replay, &all->input))
+    {
+        all->input.quit = SDL_TRUE;
+        FIN_TRACE(&all->trace);
+        return;
+    }
+    if (all->replay.enregistrement)
+    {
+        recordReplay(&all->replay, &all->input);
+    }
+    updateSimulation(all);
+    checkpointReplay(all);
+    FIN_TRACE(&all->trace);
+}
+
+void drawCompteurs(Everything *all)
+{
+    /* overlay de key_select, par-dessus l'ecran courant ; une frame de retard sur les compteurs */
+    Compteurs *compteurs = &all->compteurs;
+    PoliceAtlas *police = &all->fonts.atlas_menu_button;
+    char lignes[5][48];
+    SDL_snprintf(lignes[0], sizeof(lignes[0]), "malloc %d free %d", compteurs->nb_malloc, compteurs->nb_free);
+    SDL_snprintf(lignes[1], sizeof(lignes[1]), "sat %" SDL_PRIu64 " cercle %" SDL_PRIu64,
+                 compteurs->nb_sat_complets, compteurs->nb_rejets_cercle);
+    SDL_snprintf(lignes[2], sizeof(lignes[2]), "copy %d geometry %d", compteurs->nb_copies, compteurs->nb_geometries);
+    SDL_snprintf(lignes[3], sizeof(lignes[3]), "mob %d tir %d text %d", compteurs->nb_mobs, compteurs->nb_fireplayers, compteurs->nb_texts);
+    SDL_snprintf(lignes[4], sizeof(lignes[4]), "textures %d ko", (int)(compteurs->octets_textures / 1024));
+    for (int i = 0; i < 5; i++)
+    {
+        drawString(police, lignes[i], 4, 2 + (i + 1) * police->hauteur, all->fonts.vert_clair, all);
+    }
+}
+
+void countCompteurs(Everything *all)
+{
+    /* fin de frame : les compteurs cumules passent en valeurs par frame ; une frame de jeu est stable
+       si elle commence et finit en jeu (ni Start Game ni Game Over), et n'a alors aucune raison d'allouer */
+    Compteurs *compteurs = &all->compteurs;
+    int nb_malloc = SDL_AtomicGet(&compteurs_memoire.nb_malloc), nb_free = SDL_AtomicGet(&compteurs_memoire.nb_free);
+    SDL_bool stable = (all->game_state == 1 && compteurs->etat_precedent == 1) ? SDL_TRUE : SDL_FALSE;
+    compteurs->nb_malloc = nb_malloc - compteurs->malloc_precedent;
+    compteurs->nb_free = nb_free - compteurs->free_precedent;
+    compteurs->malloc_precedent = nb_malloc;
+    compteurs->free_precedent = nb_free;
+    compteurs->nb_rejets_cercle = compteurs_collision.nb_rejets_cercle - compteurs->rejets_precedent;
+    compteurs->nb_sat_complets = compteurs_collision.nb_sat - compteurs->sat_precedent - compteurs->nb_rejets_cercle;
+    compteurs->rejets_precedent = compteurs_collision.nb_rejets_cercle;
+    compteurs->sat_precedent = compteurs_collision.nb_sat;
+    compteurs->nb_copies = all->sprites.nb_copies_frame;
+    compteurs->nb_geometries = all->sprites.nb_draw_calls_frame;
+    compteurs->nb_mobs = all->pool_mobs.nb_utilises;
+    compteurs->nb_fireplayers = all->pool_fireplayers.nb_utilises;
+    compteurs->nb_texts = all->pool_texts.nb_utilises;
+    if (compteurs->affiche || compteurs->sortie != NULL)
+    {
+        compteurs->octets_textures = octetsTextures(all);
+    }
+    compteurs->etat_precedent = all->game_state;
+    compteurs->nb_frames++;
+    if (stable)
+    {
+        compteurs->nb_frames_jeu++;
+        if (compteurs->nb_malloc > 0)
+        {
+            compteurs->nb_frames_allocation++;
+        }
+    }
+    if (compteurs->sortie != NULL)
+    {
+        fprintf(compteurs->sortie, "%" SDL_PRIu64 ";%d;%d;%d;%" SDL_PRIu64 ";%" SDL_PRIu64 ";%d;%d;%d;%d;%d;%zu\n",
+                compteurs->nb_frames, all->game_state, compteurs->nb_malloc, compteurs->nb_free, compteurs->nb_rejets_cercle,
+                compteurs->nb_sat_complets, compteurs->nb_copies, compteurs->nb_geometries, compteurs->nb_mobs,
+                compteurs->nb_fireplayers, compteurs->nb_texts, compteurs->octets_textures);
+    }
+    if (stable && compteurs->zero_allocation && compteurs->nb_malloc > 0)
+    {
+        fprintf(stderr, "Erreur --zero-alloc : %d allocations et %d liberations pendant la frame de jeu %" SDL_PRIu64
+                " (%d mobs, %d tirs, %d textes, %" SDL_PRIu64 " sat complets, %" SDL_PRIu64 " rejets par les cercles)\n",
+                compteurs->nb_malloc, compteurs->nb_free, compteurs->nb_frames, compteurs->nb_mobs, compteurs->nb_fireplayers,
+                compteurs->nb_texts, compteurs->nb_sat_complets, compteurs->nb_rejets_cercle);
+        Quit(all, EXIT_FAILURE);
+    }
+}
+
+void drawFrame(Everything *all)
+{
+    DEBUT_TRACE(&all->trace, "drawFrame");
+    SDL_RenderClear(all->renderer);
+    all->scene->draw(all);
+    if (all->compteurs.affiche && all->game_state != ETAT_CHARGEMENT)
+    {
+        drawCompteurs(all);
+    }
+    drawLotSprites(all);
+    countLotSprites(&all->sprites);
+    FIN_TRACE(&all->trace);
+}
+
+void updateAutopilot(Everything *all, Uint64 tick)
+{
+    /* entrees synthetiques du mode headless : tir continu, aller-retour horizontal,
+       et Start hors du jeu pour relancer une partie apres chaque Game Over */
+    Input *input = &all->input;
+    input->B = SDL_TRUE;
+    input->left = ((tick / 90) % 2 == 0) ? SDL_TRUE : SDL_FALSE;
+    input->right = input->left ? SDL_FALSE : SDL_TRUE;
+    input->up = SDL_FALSE;
+    input->down = SDL_FALSE;
+    input->start = (all->game_state != 1) ? SDL_TRUE : SDL_FALSE;
+    input->select = SDL_FALSE;
+    input->A = SDL_FALSE;
+    input->L = SDL_FALSE;
+    input->R = SDL_FALSE;
+    input->wanted_input = -1;
+}
+
+void runHeadless(Everything *all, Uint64 nb_ticks)
+{
+    /* simulation seule, aussi vite que le CPU le permet */
+    Uint64 debut, duree, tick;
+    double secondes;
+    debut = SDL_GetPerformanceCounter();
+    for (tick = 0; tick < nb_ticks && !all->input.quit; tick++)
+    {
+        all->trace.frame = (Uint32)tick;
+        DEBUT_TRACE(&all->trace, "tick");
+        if (all->replay.lecture)
+        {
+            if (!readReplay(&all->replay, &all->input))
+            {
+                FIN_TRACE(&all->trace);
+                break;
             }
-            all->input.waiting_for_input = SDL_FALSE;
         }
-        else if (all->level.selected_button != &all->level.control_back_to_settings)
+        else
         {
-            all->input.waiting_for_input = SDL_TRUE;
+            updateAutopilot(all, tick);
         }
-    }
+        if (all->replay.enregistrement)
+        {
+            recordReplay(&all->replay, &all->input);
+        }
+        updateSimulation(all);
+        checkpointReplay(all);
+        countCompteurs(all);
+        FIN_TRACE(&all->trace);
+    }
+    duree = SDL_GetPerformanceCounter() - debut;
+    secondes = (double)duree / SDL_GetPerformanceFrequency();
+    printf("Headless : %" SDL_PRIu64 " ticks en %.3f s, %.0f ticks/s\n", tick, secondes, secondes > 0 ? tick / secondes : 0.0);
+}
 
-    /* Affichage du Menu Principal */
+int compareUint64(const void *a, const void *b)
+{
+    Uint64 x = *(const Uint64 *)a, y = *(const Uint64 *)b;
+    return (x > y) - (x < y);
+}
 
-    if (all->level.texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.texture, &all->level.src_rect, NULL);
-    }
-    if (all->level.control_settings_title->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.control_settings_title->texture, NULL, &all->level.control_settings_title->dst_rect);
-    }
-    if (all->level.chg_up.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.chg_up.text->texture, NULL, &all->level.chg_up.text->dst_rect);
-    }
-    if (all->level.chg_down.text->texture != NULL)
-    {
-        SDL_RenderCopy(all->renderer, all->level.chg_down.text->texture, NULL, &all->level.chg_down.text->dst_rect);
-    }
-    if (all->level.chg_left.text->texture != NULL)
+void fillStress(Everything *all, int nb_mobs, int nb_fires)
+{
+    /* complete les listes jusqu'aux effectifs voulus avec les vrais loadMob/loadFirePlayer */
+    int n;
+    Mob *mob;
+    FirePlayer *fire;
+    n = 0;
+    for (mob = all->liste_mob.suivant; mob != NULL; mob = mob->suivant)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_left.text->texture, NULL, &all->level.chg_left.text->dst_rect);
+        n++;
     }
-    if (all->level.chg_right.text->texture != NULL)
+    for (; n < nb_mobs; n++)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_right.text->texture, NULL, &all->level.chg_right.text->dst_rect);
+        mob = loadMob(all);
+        if (mob != NULL)
+        {
+            moveMob(10 + rand() % 300, 10 + rand() % 190, mob);
+        }
     }
-    if (all->level.chg_A.text->texture != NULL)
+    n = 0;
+    for (fire = all->liste_fireplayer.suivant; fire != NULL; fire = fire->suivant)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_A.text->texture, NULL, &all->level.chg_A.text->dst_rect);
+        n++;
     }
-    if (all->level.chg_B.text->texture != NULL)
+    for (; n < nb_fires; n++)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_B.text->texture, NULL, &all->level.chg_B.text->dst_rect);
+        fire = loadFirePlayer(all);
+        if (fire != NULL)
+        {
+            moveFirePlayer(10 + rand() % 300, 20 + rand() % 210, fire);
+        }
     }
-    if (all->level.chg_L.text->texture != NULL)
+}
+
+void benchEffectifs(Everything *all, const char liste[], int nb_threads, SDL_bool json, FILE *sortie, SDL_bool *premier)
+{
+    /* une ligne de resultats par effectif de la liste, avec nb_threads travailleurs */
+    int nb_frames = 200, nb_entites, nb_mobs, nb_fires;
+    Uint64 frequence = SDL_GetPerformanceFrequency(), debut, duree_totale, nb_mises_a_jour;
+    Uint64 nb_sat, nb_paires, nb_allocations_pool;
+    Uint64 *durees = SDL_malloc(nb_frames * sizeof(Uint64));
+    int nb_allocations_tas;
+    char *fin;
+    srand(42);
+    while (*liste != '\0')
+    {
+        nb_entites = (int)SDL_strtol(liste, &fin, 10);
+        if (fin == liste || nb_entites <= 0 || (*fin != '\0' && *fin != ','))
+        {
+            fprintf(stderr, "Erreur : --bench-stress attend une liste d'effectifs positifs separes par des virgules\n");
+            break;
+        }
+        liste = (*fin == ',') ? fin + 1 : fin;
+        nb_mobs = nb_entites / 2;
+        nb_fires = nb_entites - nb_mobs;
+
+        /* pools, grille et lot dimensionnes pour l'effectif teste */
+        while (all->liste_mob.suivant != NULL)
+        {
+            destroyMob(all->liste_mob.suivant, all);
+        }
+        resetVagues(all);
+        while (all->liste_fireplayer.suivant != NULL)
+        {
+            destroyFirePlayer(all->liste_fireplayer.suivant, all);
+        }
+        destroyPool(&all->pool_mobs);
+        destroyPool(&all->pool_fireplayers);
+        destroyGrille(&all->grille_fireplayers);
+        destroyLot(&all->lot);
+        createPool(&all->pool_mobs, "Mob", sizeof(Mob), nb_mobs, NULL);
+        createPool(&all->pool_fireplayers, "FirePlayer", sizeof(FirePlayer), nb_fires, NULL);
+        createGrille(&all->grille_fireplayers, nb_fires, 4 * nb_fires);
+        createLot(&all->lot, nb_fires);
+        destroyOrdonnanceur(all);
+        createOrdonnanceur(all, nb_threads);
+
+        duree_totale = 0;
+        nb_mises_a_jour = 0;
+        nb_allocations_tas = 0;     /* allocations faites, meme liberees dans la frame, et non allocations en cours */
+        compteurs_collision.nb_sat = 0;
+        compteurs_collision.nb_paires_lot = 0;
+        for (int f = 0; f < nb_frames; f++)
+        {
+            fillStress(all, nb_mobs, nb_fires);
+            nb_mises_a_jour += all->pool_mobs.nb_utilises + all->pool_fireplayers.nb_utilises;
+            nb_allocations_tas -= SDL_AtomicGet(&compteurs_memoire.nb_malloc);
+            debut = SDL_GetPerformanceCounter();
+            updateFirePlayers(all);
+            updateMobs(all);
+            durees[f] = SDL_GetPerformanceCounter() - debut;
+            nb_allocations_tas += SDL_AtomicGet(&compteurs_memoire.nb_malloc);
+            duree_totale += durees[f];
+        }
+        nb_sat = compteurs_collision.nb_sat;
+        nb_paires = compteurs_collision.nb_paires_lot;
+        nb_allocations_pool = all->pool_mobs.nb_allocations + all->pool_fireplayers.nb_allocations;
+        SDL_qsort(durees, nb_frames, sizeof(Uint64), compareUint64);
+
+        fprintf(sortie, json ? "%s\n  {\"threads\":%d,\"entites\":%d,\"mobs\":%d,\"tirs\":%d,\"frames\":%d,\"ns_par_entite\":%.1f,\"sat_par_frame\":%.1f,"
+                      "\"paires_lot_par_frame\":%.1f,\"allocations_pool_par_frame\":%.1f,\"allocations_tas_par_frame\":%.1f,"
+                      "\"frame_p50_us\":%.1f,\"frame_p99_us\":%.1f}"
+                    : "%s%d;%d;%d;%d;%d;%.1f;%.1f;%.1f;%.1f;%.1f;%.1f;%.1f\n",
+               (json && !*premier) ? "," : "", all->ordonnanceur.nb_threads, nb_entites, nb_mobs, nb_fires, nb_frames,
+               1e9 * duree_totale / frequence / (nb_mises_a_jour > 0 ? nb_mises_a_jour : 1),
+               (double)nb_sat / nb_frames, (double)nb_paires / nb_frames,
+               (double)nb_allocations_pool / nb_frames, (double)nb_allocations_tas / nb_frames,
+               1e6 * durees[nb_frames / 2] / frequence, 1e6 * durees[nb_frames * 99 / 100] / frequence);
+        *premier = SDL_FALSE;
+    }
+    SDL_free(durees);
+}
+
+void benchStress(Everything *all, const char liste[], const char liste_threads[], SDL_bool json, FILE *sortie)
+{
+    /* fait tourner updateFirePlayers et updateMobs sur des effectifs croissants, remis a niveau a chaque frame,
+       pour chaque nombre de threads de liste_threads (par defaut celui de --threads) */
+    SDL_bool premier = SDL_TRUE;
+    int nb_threads;
+    char *fin;
+    changeScene(all, 1);
+    updateGame(all);
+    if (json)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_L.text->texture, NULL, &all->level.chg_L.text->dst_rect);
+        fprintf(sortie, "[");
     }
-    if (all->level.chg_R.text->texture != NULL)
+    else
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_R.text->texture, NULL, &all->level.chg_R.text->dst_rect);
+        fprintf(sortie, "threads;entites;mobs;tirs;frames;ns_par_entite;sat_par_frame;paires_lot_par_frame;allocations_pool_par_frame;allocations_tas_par_frame;frame_p50_us;frame_p99_us\n");
     }
-    if (all->level.chg_start.text->texture != NULL)
+    if (liste_threads == NULL)
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_start.text->texture, NULL, &all->level.chg_start.text->dst_rect);
+        benchEffectifs(all, liste, all->ordonnanceur.nb_threads, json, sortie, &premier);
     }
-    if (all->level.chg_select.text->texture != NULL)
+    while (liste_threads != NULL && *liste_threads != '\0')
     {
-        SDL_RenderCopy(all->renderer, all->level.chg_select.text->texture, NULL, &all->level.chg_select.text->dst_rect);
+        nb_threads = (int)SDL_strtol(liste_threads, &fin, 10);
+        if (fin == liste_threads || nb_threads <= 0 || nb_threads > NB_THREADS_MAX || (*fin != '\0' && *fin != ','))
+        {
+            fprintf(stderr, "Erreur : --bench-threads attend une liste de nombres de threads entre 1 et %d separes par des virgules\n", NB_THREADS_MAX);
+            break;
+        }
+        liste_threads = (*fin == ',') ? fin + 1 : fin;
+        benchEffectifs(all, liste, nb_threads, json, sortie, &premier);
     }
-    if (all->level.control_back_to_settings.text->texture != NULL)
+    if (json)
     {
-        SDL_RenderCopy(all->renderer, all->level.control_back_to_settings.text->texture, NULL, &all->level.control_back_to_settings.text->dst_rect);
+        fprintf(sortie, "\n]\n");
     }
 }
 
-void updateGameState(Everything *all)
+int main(int argc, char *argv[])
 {
-    switch (all->game_state)
-    {
-        case 0 :        /* Title Screen */
+    /* Création des variables ; les compteurs d'allocations passent avant tout appel a la SDL */
+
+    installCompteursMemoire();
+    Uint64 lancement = SDL_GetPerformanceCounter();
+    Everything all = {.renderer = NULL, .window = NULL};
+    all.input.quit = SDL_FALSE;
+    all.game_state = 0;
+    all.textures.liste_texture.suivant = NULL;
+    all.dernier_mob = &all.liste_mob;
+    all.textures.nb_hits = 0;
+    all.textures.nb_misses = 0;
+    all.input.enfonce = 0;
+    all.input.presse = 0;
+    all.input.relache = 0;
+    all.input.horodatage = 0;
+
+    int ticks_par_seconde = TICKS_PAR_SECONDE, nb_threads = SDL_GetCPUCount();
+    Uint64 nb_ticks_headless = 0;
+    const char *chemin_record = NULL, *chemin_replay = NULL, *liste_stress = NULL, *chemin_sortie = NULL, *liste_threads = NULL;
+    SDL_bool json = SDL_FALSE, latence = SDL_FALSE;
+    Uint32 graine = (Uint32)SDL_GetPerformanceCounter();
+    for (int i = 1; i < argc; i++)
+    {
+        if (SDL_strcmp(argv[i], "--test") == 0)
         {
-            if (all->input.start)
+            return quitAvantInit(&all, runTests());
+        }
+        else if (SDL_strcmp(argv[i], "--bench-collisions") == 0)
+        {
+            benchCollisions();
+            return quitAvantInit(&all, EXIT_SUCCESS);
+        }
+        else if (SDL_strcmp(argv[i], "--tps") == 0 && i + 1 < argc)
+        {
+            ticks_par_seconde = SDL_atoi(argv[++i]);
+            if (ticks_par_seconde <= 0)
             {
-                if (all->level.selected_button == &all->level.start_game)
-                {
-                    /* Start Game */
-                    all->game_state = 1;
-                    loadPlayer(all);
-                    if (all->level.title != NULL)
-                    {
-                        destroyText(all->level.title, all);
-                        all->level.title = NULL;
-                    }
-                    if (all->level.start_game.text != NULL)
-                    {
-                        destroyText(all->level.start_game.text, all);
-                        all->level.start_game.text = NULL;
-                    }
-                    if (all->level.settings.text != NULL)
-                    {
-                        destroyText(all->level.settings.text, all);
-                        all->level.settings.text = NULL;
-                    }
-                    if (all->level.quit_game.text != NULL)
-                    {
-                        destroyText(all->level.quit_game.text, all);
-                        all->level.quit_game.text = NULL;
-                    }
-                    all->level.selected_button = NULL;
-                }
-                else if (all->level.selected_button == &all->level.settings)
-                {
-                    /* Go to the Settings Menu */
-                    all->game_state = 3;
-                    if (all->level.title != NULL)
-                    {
-                        destroyText(all->level.title, all);
-                        all->level.title = NULL;
-                    }
-                    if (all->level.start_game.text != NULL)
-                    {
-                        destroyText(all->level.start_game.text, all);
-                        all->level.start_game.text = NULL;
-                    }
-                    if (all->level.settings.text != NULL)
-                    {
-                        destroyText(all->level.settings.text, all);
-                        all->level.settings.text = NULL;
-                    }
-                    if (all->level.quit_game.text != NULL)
-                    {
-                        destroyText(all->level.quit_game.text, all);
-                        all->level.quit_game.text = NULL;
-                    }
-                    all->level.selected_button = NULL;
-                }
-                else if (all->level.selected_button == &all->level.quit_game)
-                {
-                    /* Quit Game */
-                    all->input.quit = SDL_TRUE;
-                    all->level.selected_button = NULL;
-                }
+                fprintf(stderr, "Erreur : --tps attend un nombre de ticks par seconde positif\n");
+                return quitAvantInit(&all, EXIT_FAILURE);
             }
-            break;
         }
-        case 1 :        /* Game */
+        else if (SDL_strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
         {
-            if (all->player.PV <= 0)
+            /* 1 : tout sur le thread principal ; le resultat de la simulation ne depend pas de ce nombre */
+            nb_threads = SDL_atoi(argv[++i]);
+            if (nb_threads <= 0 || nb_threads > NB_THREADS_MAX)
             {
-                /* Game Over */
-                all->game_state = 2;
-                destroyPlayer(all);
-                if (all->level.hitboxes != NULL)
-                {
-                    for (int i = 0; i < all->level.nb_hitboxes; i++)
-                    {
-                        if (all->level.hitboxes[i].points != NULL)
-                        {
-                            SDL_free(all->level.hitboxes[i].points);
-                        }
-                    }
-                    SDL_free(all->level.hitboxes);
-                    all->level.hitboxes = NULL;
-                    all->level.nb_hitboxes = 0;
-                }
-                while (all->liste_fireplayer.suivant != NULL)
-                {
-                    destroyFirePlayer(all->liste_fireplayer.suivant, all);
-                }
-                while (all->liste_mob.suivant != NULL)
-                {
-                    destroyMob(all->liste_mob.suivant, all);
-                }
+                fprintf(stderr, "Erreur : --threads attend un nombre de threads entre 1 et %d\n", NB_THREADS_MAX);
+                return quitAvantInit(&all, EXIT_FAILURE);
             }
-            break;
         }
-        case 2 :        /* Game Over Screen */
+        else if (SDL_strcmp(argv[i], "--headless") == 0)
         {
-            if (all->input.start)
+            all.headless = SDL_TRUE;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
             {
-                /* Return to Menu */
-                all->game_state = 0;
-                if (all->level.game_over != NULL)
-                {
-                    destroyText(all->level.game_over, all);
-                    all->level.game_over = NULL;
-                }
+                nb_ticks_headless = SDL_strtoull(argv[++i], NULL, 10);
             }
-            break;
         }
-        case 3 :        /* Settings Menu */
+        else if (SDL_strcmp(argv[i], "--record") == 0 && i + 1 < argc)
         {
-            if (all->input.start)
+            chemin_record = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            chemin_replay = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--bench-stress") == 0)
+        {
+            liste_stress = "100,1000,5000,10000";
+            if (i + 1 < argc && argv[i + 1][0] != '-')
             {
-                if (all->level.selected_button == &all->level.control_settings)
-                {
-                    /* Go to the Control Settings */
-                    all->game_state = 4;
-                    if (all->level.settings_title != NULL)
-                    {
-                        destroyText(all->level.settings_title, all);
-                        all->level.settings_title = NULL;
-                    }
-                    if (all->level.back_to_menu.text != NULL)
-                    {
-                        destroyText(all->level.back_to_menu.text, all);
-                        all->level.back_to_menu.text = NULL;
-                    }
-                    if (all->level.control_settings.text != NULL)
-                    {
-                        destroyText(all->level.control_settings.text, all);
-                        all->level.control_settings.text = NULL;
-                    }
-                    all->level.selected_button = NULL;
-                }
-                else if (all->level.selected_button == &all->level.back_to_menu)
-                {
-                    /* Go back to the Main Menu */
-                    all->game_state = 0;
-                    if (all->level.settings_title != NULL)
-                    {
-                        destroyText(all->level.settings_title, all);
-                        all->level.settings_title = NULL;
-                    }
-                    if (all->level.back_to_menu.text != NULL)
-                    {
-                        destroyText(all->level.back_to_menu.text, all);
-                        all->level.back_to_menu.text = NULL;
-                    }
-                    if (all->level.control_settings.text != NULL)
-                    {
-                        destroyText(all->level.control_settings.text, all);
-                        all->level.control_settings.text = NULL;
-                    }
-                    all->level.selected_button = NULL;
-                }
+                liste_stress = argv[++i];
             }
         }
-        case 4 :        /* Control Settings */
+        else if (SDL_strcmp(argv[i], "--bench-threads") == 0 && i + 1 < argc)
         {
-            if (all->input.start)
+            liste_threads = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--pack-atlas") == 0)
+        {
+            /* sans liste de fichiers, les sprites du jeu ; hors SDL_Init : seules les surfaces servent */
+            const char *sprites[] = {CHEMINS_SPRITES};
+            if (i + 1 < argc)
             {
-                if (all->level.selected_button == &all->level.control_back_to_settings)
-                {
-                    /* Go to Settings */
-                    all->game_state = 3;
-                    if (all->level.control_settings_title != NULL)
-                    {
-                        destroyText(all->level.control_settings_title, all);
-                        all->level.control_settings_title = NULL;
-                    }
-                    if (all->level.chg_up.text != NULL)
-                    {
-                        destroyText(all->level.chg_up.text, all);
-                        all->level.chg_up.text = NULL;
-                    }
-                    if (all->level.chg_down.text != NULL)
-                    {
-                        destroyText(all->level.chg_down.text, all);
-                        all->level.chg_down.text = NULL;
-                    }
-                    if (all->level.chg_left.text != NULL)
-                    {
-                        destroyText(all->level.chg_left.text, all);
-                        all->level.chg_left.text = NULL;
-                    }
-                    if (all->level.chg_right.text != NULL)
-                    {
-                        destroyText(all->level.chg_right.text, all);
-                        all->level.chg_right.text = NULL;
-                    }
-                    if (all->level.chg_A.text != NULL)
-                    {
-                        destroyText(all->level.chg_A.text, all);
-                        all->level.chg_A.text = NULL;
-                    }
-                    if (all->level.chg_B.text != NULL)
-                    {
-                        destroyText(all->level.chg_B.text, all);
-                        all->level.chg_B.text = NULL;
-                    }
-                    if (all->level.chg_L.text != NULL)
-                    {
-                        destroyText(all->level.chg_L.text, all);
-                        all->level.chg_L.text = NULL;
-                    }
-                    if (all->level.chg_R.text != NULL)
-                    {
-                        destroyText(all->level.chg_R.text, all);
-                        all->level.chg_R.text = NULL;
-                    }
-                    if (all->level.chg_start.text != NULL)
-                    {
-                        destroyText(all->level.chg_start.text, all);
-                        all->level.chg_start.text = NULL;
-                    }
-                    if (all->level.chg_select.text != NULL)
-                    {
-                        destroyText(all->level.chg_select.text, all);
-                        all->level.chg_select.text = NULL;
-                    }
-                    if (all->level.control_back_to_settings.text != NULL)
-                    {
-                        destroyText(all->level.control_back_to_settings.text, all);
-                        all->level.control_back_to_settings.text = NULL;
-                    }
-                    all->level.selected_button = NULL;
-                }
+                return quitAvantInit(&all, packAtlas((const char **)&argv[i + 1], argc - i - 1));
+            }
+            return quitAvantInit(&all, packAtlas(sprites, sizeof(sprites) / sizeof(sprites[0])));
+        }
+        else if (SDL_strcmp(argv[i], "--pack-archive") == 0)
+        {
+            /* sans liste de fichiers, tout ce que le jeu lit a l'execution (a lancer apres --pack-atlas) */
+            const char *ressources[] = {CHEMIN_ICONE, CHEMINS_POLICES, CHEMINS_SPRITES, CHEMIN_ATLAS_IMAGE, CHEMIN_ATLAS_INDEX, CHEMIN_VAGUES, CHEMIN_NIVEAU};
+            if (i + 1 < argc)
+            {
+                return quitAvantInit(&all, packArchive((const char **)&argv[i + 1], argc - i - 1));
+            }
+            return quitAvantInit(&all, packArchive(ressources, sizeof(ressources) / sizeof(ressources[0])));
+        }
+        else if (SDL_strcmp(argv[i], "--json") == 0)
+        {
+            json = SDL_TRUE;
+        }
+        else if (SDL_strcmp(argv[i], "--latence") == 0)
+        {
+            latence = SDL_TRUE;
+        }
+        else if (SDL_strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc)
+        {
+            chemin_sortie = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            if (!createTrace(&all.trace, argv[++i]))
+            {
+                return quitAvantInit(&all, EXIT_FAILURE);
             }
         }
+        else if (SDL_strcmp(argv[i], "--compteurs") == 0 && i + 1 < argc)
+        {
+            if (!createCompteurs(&all.compteurs, argv[++i]))
+            {
+                return quitAvantInit(&all, EXIT_FAILURE);
+            }
+        }
+        else if (SDL_strcmp(argv[i], "--zero-alloc") == 0)
+        {
+            all.compteurs.zero_allocation = SDL_TRUE;
+        }
+        else if (SDL_strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            graine = (Uint32)SDL_strtoul(argv[++i], NULL, 10);
+        }
     }
-}
 
-int main(int argc, char *argv[])
-{
-    /* Création des variables */
+    /* replay : la graine et la cadence enregistrees remplacent celles de la ligne de commande ;
+       l'archive est chargee avant pour que le hash porte sur les donnees que le jeu lira */
 
-    Everything all = {.renderer = NULL, .window = NULL};
-    all.input.quit = SDL_FALSE;
-    all.game_state = 0;
-    for (int i = 0; i < SDL_NUM_SCANCODES; i++)
-        all.input.key[i] = SDL_FALSE;
+    loadArchive();
+    if (chemin_replay != NULL)
+    {
+        if (!openReplay(&all.replay, chemin_replay, SDL_FALSE, 0, 0, hashDonnees()))
+        {
+            return quitAvantInit(&all, EXIT_FAILURE);
+        }
+        graine = all.replay.graine;
+        ticks_par_seconde = all.replay.ticks_par_seconde;
+    }
+    else if (chemin_record != NULL)
+    {
+        if (!openReplay(&all.replay, chemin_record, SDL_TRUE, ticks_par_seconde, graine, hashDonnees()))
+        {
+            return quitAvantInit(&all, EXIT_FAILURE);
+        }
+    }
+    srand(graine);
+    if (nb_ticks_headless == 0)
+    {
+        /* sans nombre de ticks, un replay headless va jusqu'au bout du fichier */
+        nb_ticks_headless = all.replay.lecture ? SDL_MAX_UINT64 : 100000;
+    }
+
+    /* benchmark de charge : vrai renderer, mais sur les pilotes video dummy et software de la SDL */
+
+    if (liste_stress != NULL)
+    {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    }
 
     /* Initialisation, création de la fenêtre et du renderer. */
 
     Init(&all);
+    createPool(&all.pool_mobs, "Mob", sizeof(Mob), CAPACITE_MOBS, &all.session.arene);
+    createPool(&all.pool_fireplayers, "FirePlayer", sizeof(FirePlayer), CAPACITE_FIREPLAYERS, &all.session.arene);
+    createPool(&all.pool_texts, "Text", sizeof(Text), CAPACITE_TEXTS, NULL);
+    createGrille(&all.grille_level, NB_OBSTACLES_MAX, NB_OBSTACLES_MAX * NB_CELLULES_X * NB_CELLULES_Y);
+    createGrille(&all.grille_fireplayers, CAPACITE_FIREPLAYERS, 4 * CAPACITE_FIREPLAYERS);
+    createLot(&all.lot, CAPACITE_FIREPLAYERS);
+    createProjectiles(&all.projectiles, CAPACITE_PROJECTILES, &all.session.arene);
+    createOrdonnanceur(&all, nb_threads);
+    if (!all.headless)
+    {
+        createLotSprites(&all.sprites, CAPACITE_SPRITES);
+    }
 
-    /* Chargement des options et du level */
+    /* Chargement des options et du level ; polices, textes et images sur le thread de chargement
+       en jeu normal, sinon de maniere synchrone (le benchmark n'affiche aucun texte) */
 
-    loadFonts(&all);
+    loadFormes(&all);
     loadOptions(&all);
     loadLevel(&all);
+    loadNiveau(&all);
+    loadVagues(&all);
+    createSession(&all);
+    loadAtlas(&all);
+    loadScenes(&all);
+    if (!all.headless && (liste_stress != NULL || !startChargeur(&all)))
+    {
+        loadFonts(&all);
+        if (liste_stress == NULL)
+        {
+            loadLabels(&all);
+        }
+    }
 
-    /* Boucle principale du jeu */
+    if (all.headless)
+    {
+        runHeadless(&all, nb_ticks_headless);
+        Quit(&all, EXIT_SUCCESS);
+    }
 
-    while (!all.input.quit)
+    if (liste_stress != NULL)
     {
-        updateEvent(&all.input);
-        SDL_RenderClear(all.renderer);
+        /* resultats dans un fichier pour ne pas les melanger aux bilans des pools et de Quit */
+        if (chemin_sortie == NULL)
+        {
+            chemin_sortie = json ? "bench_stress.json" : "bench_stress.csv";
+        }
+        FILE *sortie = fopen(chemin_sortie, "w");
+        if (sortie == NULL)
+        {
+            fprintf(stderr, "Erreur fopen : impossible d'ecrire %s\n", chemin_sortie);
+            Quit(&all, EXIT_FAILURE);
+        }
+        benchStress(&all, liste_stress, liste_threads, json, sortie);
+        fclose(sortie);
+        printf("Benchmark de charge ecrit dans %s\n", chemin_sortie);
+        Quit(&all, EXIT_SUCCESS);
+    }
 
-        switch (all.game_state)
-        {   
-            case 0 :        /* Title Screen */
-            {
-                updateMainmenu(&all);
-                break;
-            };
-            case 1 :       /* Game */
-            {
-                updateGame(&all);
-                updatePlayer(&all);
-                updateMobs(&all);
-                break;
-            }
-            case 2 :       /* Game Over Screen */
-            {
-                updateGameover(&all);
-                break;
-            }
-            case 3 :        /* Settings Menu */
-            {
-                updateSettings(&all);
-                break;
-            }
-            case 4 :        /* Control Settings */
+    /* Boucle principale du jeu : pas de temps fixe, chaque tick avance la simulation d'un pas */
+
+    initHorloge(&all.horloge, ticks_par_seconde);
+    all.horloge.mesure_latence = latence;
+    while (!all.input.quit)
+    {
+        Uint64 debut_frame = SDL_GetPerformanceCounter();
+        int game_state = all.game_state;
+        DEBUT_TRACE(&all.trace, "frame");
+        for (int nb_ticks = ticksHorloge(&all.horloge); nb_ticks > 0 && !all.input.quit; nb_ticks--)
+        {
+            updateTick(&all);
+        }
+        updateChargeur(&all);
+        drawFrame(&all);
+        DEBUT_TRACE(&all.trace, "SDL_RenderPresent");
+        SDL_RenderPresent(all.renderer);
+        FIN_TRACE(&all.trace);
+        countCompteurs(&all);
+        if (all.game_state != game_state && game_state != ETAT_CHARGEMENT)
+        {
+            /* la fin du chargement n'est pas un changement d'ecran : elle compte dans measureDemarrage */
+            measureTransition(&all.horloge, debut_frame);
+        }
+        if (all.horloge.duree_premier_menu == 0)
+        {
+            measureDemarrage(&all.horloge, lancement, all.game_state != ETAT_CHARGEMENT);
+        }
+        if (all.input.horodatage != 0)
+        {
+            if (all.horloge.mesure_latence)
             {
-                updateControlsettings(&all);
-                break;
+                measureLatence(&all.horloge, all.input.horodatage);
             }
+            all.input.horodatage = 0;
         }
-        updateGameState(&all);
-        
-        SDL_RenderPresent(all.renderer);
-        SDL_Delay( (int)(1000 / 60) );
+        DEBUT_TRACE(&all.trace, "waitHorloge");
+        waitHorloge(&all.horloge);
+        FIN_TRACE(&all.trace);
+        FIN_TRACE(&all.trace);
+        all.trace.frame++;
     }
 
     /* Fermeture du logiciel et libération de la mémoire */